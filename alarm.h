@@ -11,6 +11,21 @@
  *        время срабатывания, а нам нужно настраивать время начала и окончания
  *        сигнализации и интервал срабатывания;
  *
+ *        поддерживается несколько независимых промежутков сигнализации,
+ *        каждый со своим временем начала, окончания и интервалом;
+ *
+ *        кроме того, вместо промежутков можно задать произвольный список
+ *        точек срабатывания ("расписание звонков");
+ *
+ *        для каждого дня недели задается набор промежутков, действующих в
+ *        этот день (в режиме списка - включен список или нет); план дня -
+ *        карта точек срабатывания - строится один раз при смене дня или
+ *        настроек, поэтому проверка будильника от дня недели не зависит;
+ *
+ *        в календаре исключений отмечаются даты (праздники и т.п.), в
+ *        которые будильник не срабатывает; календарь проверяется тоже один
+ *        раз в сутки при построении плана дня;
+ *
  * @version 1.0
  * @date 2026-06-09
  *
@@ -20,20 +35,79 @@
 #pragma once
 #include <Arduino.h>
 #include <EEPROM.h>
+#include "header_file.h"
+#include "eeprom_queue.h"
+#include "eeprom_journal.h"
+#include "buzzer.h"
+#include "fast_pin.h"
 
 #define MAX_DATA 1439        // максимальное количество минут для установки будильника (23 ч, 59 мин)
 #define MAX_INTERVAL 180     // максимальный интервал, минут
 #define MIN_INTERVAL 10      // минимальный интервал, минут
 #define INTERVAL_INC_STEP 10 // шаг изменения интервала, минут
-#define ALARM_DURATION 60    // продолжительность сигнала будильника, секунд
+#define ALARM_DURATION 60    // продолжительность сигнала будильника по умолчанию, секунд
+#define ALARM_MAX_DURATION 600 // максимальная продолжительность сигнала будильника, секунд
+#define ALARM_WINDOW_COUNT 3 // количество промежутков сигнализации
+#define ALARM_LIST_SIZE 32   // максимальное количество точек в списке срабатывания
+#define ALARM_LIST_BLOCK_SIZE (3 + (ALARM_LIST_SIZE - 1) * 2) // максимальный размер блока списка точек в EEPROM, байт
+#define ALARM_DAY_COUNT 7    // количество дней недели
+#define ALARM_ALL_WINDOWS ((1 << ALARM_WINDOW_COUNT) - 1) // маска всех промежутков
+#define ALARM_DATE_COUNT 366   // количество дат в году, включая 29 февраля
+#define ALARM_HOLIDAYS_SIZE ((ALARM_DATE_COUNT + 7) / 8) // размер календаря исключений в EEPROM, байт
+#define ALARM_NO_DATE 0xFFFF   // дата еще не задана
+#define ALARM_NO_POINT 0xFFFF  // точек срабатывания нет
+
+#define ALARM_JOURNAL_SLOT_COUNT 8 // количество слотов журнала настроек в EEPROM
+#define ALARM_SETTINGS_VERSION 2   // версия формата записи настроек в журнале
+#define ALARM_SETTINGS_V1_SIZE (3 + 6 * ALARM_WINDOW_COUNT) // размер данных записи версии 1 - on_off, mode, window_mask и промежутки, байт
+
+#define ALARM_GUARD_MAX_SLEEP 600     // максимальный интервал между проверками будильника, секунд
+#define ALARM_GUARD_FINE_TIME 2       // за сколько секунд до события переходить к частым проверкам
+#define ALARM_GUARD_FINE_INTERVAL 200 // интервал частых проверок, мс
+
+/*
+ * настройки будильника (AlarmSettings) хранятся в журнале EEPROM, начиная с
+ * индекса ALARM_JOURNAL_EEPROM_INDEX (см. eeprom_journal.h); размер журнала -
+ * ALARM_JOURNAL_SIZE байт; записи версии 1 (без мелодии и продолжительности
+ * сигнала, ALARM_SETTINGS_V1_SIZE байт данных) лежат в той же области в
+ * слотах меньшего размера и при первой загрузке переносятся в журнал
+ * версии 2
+ */
+
+enum IndexOffset : uint8_t // смещение от стартового индекса в EEPROM настроек прежних версий прошивки; используется только для переноса настроек в журнал
+{
+  ALARM_STATE = 0,    // состояние будильника, включен/нет, uint8_t
+  ALARM_POINT_1 = 1,  // начало отсчета времени сигнализации в минутах от полуночи, uint16_t
+  ALARM_POINT_2 = 3,  // конец отсчета времени сигнализации в минутах от полуночи, uint16_t
+  ALARM_INTERVAL = 5  // интервал срабатывания будильника в минутах, uint16_t
+};
+
+/*
+ * список точек срабатывания хранится в EEPROM отдельным блоком:
+ * количество точек (uint8_t), первая точка (uint16_t), затем разности между
+ * соседними точками; разность меньше 0x80 занимает один байт, иначе - два
+ * байта со старшим битом первого байта, установленным в 1;
+ * максимальный размер блока - ALARM_LIST_BLOCK_SIZE байт
+ */
+
+/*
+ * наборы промежутков по дням недели хранятся в EEPROM отдельным блоком из
+ * ALARM_DAY_COUNT байт - битовых масок промежутков, действующих в этот день,
+ * начиная с воскресенья; 0 - в этот день будильник не срабатывает;
+ * недопустимое значение, в т.ч. 0xFF чистой EEPROM, означает все промежутки
+ */
+
+/*
+ * календарь исключений хранится в EEPROM блоком из ALARM_HOLIDAYS_SIZE байт,
+ * бит на дату, номер даты - по getDateIndex() из time_source.h; сброшенный
+ * бит означает дату-исключение, поэтому чистая EEPROM - пустой календарь;
+ * в памяти хранится его копия, в EEPROM записываются только измененные байты
+ */
 
-enum IndexOffset : uint8_t // смещение от стартового индекса в EEPROM для хранения настроек
-/* общий размер настроек - 7 байт */
+enum AlarmMode : uint8_t // режим работы будильника
 {
-  ALARM_STATE = 0,   // состояние будильника, включен/нет, uint8_t
-  ALARM_POINT_1 = 1, // начало отсчета времени сигнализации в минутах от полуночи, uint16_t
-  ALARM_POINT_2 = 3, // конец отсчета времени сигнализации в минутах от полуночи, uint16_t
-  ALARM_INTERVAL = 5 // интервал срабатывания будильника в минутах, uint16_t
+  ALARM_MODE_INTERVAL, // срабатывание через равные интервалы в заданных промежутках
+  ALARM_MODE_LIST      // срабатывание по списку точек
 };
 
 enum AlarmState : uint8_t // состояние будильника
@@ -43,36 +117,346 @@ enum AlarmState : uint8_t // состояние будильника
   ALARM_YES  // будильник сработал
 };
 
+enum AlarmUpdateFlag : uint8_t // флаги пакетного изменения настроек
+{
+  ALARM_UPDATE_ACTIVE = 0x01,   // идет пакетное изменение
+  ALARM_UPDATE_SETTINGS = 0x02, // изменены настройки, нужна запись журнала
+  ALARM_UPDATE_LIST = 0x04,     // изменен список точек, нужна его запись
+  ALARM_UPDATE_SCHEDULE = 0x08, // нужно перестроить карту точек срабатывания
+  ALARM_UPDATE_DAYS = 0x10,     // изменены наборы промежутков по дням недели, нужна их запись
+  ALARM_UPDATE_HOLIDAYS = 0x20  // изменен календарь исключений, нужна его запись
+};
+
+struct AlarmWindow // промежуток сигнализации
+{
+  uint16_t point_1;  // начало отсчета времени сигнализации в минутах от полуночи
+  uint16_t point_2;  // конец отсчета времени сигнализации в минутах от полуночи
+  uint16_t interval; // интервал срабатывания в минутах
+};
+
+struct AlarmCursor // позиция в плане дня - итератор точек срабатывания, см. seekPoint()
+{
+  uint16_t point; // точка срабатывания в минутах от полуночи, ALARM_NO_POINT - точек нет
+  uint16_t left;  // количество точек от этой до конца суток, включая ее
+};
+
+struct AlarmSettings // блок настроек будильника, хранится в журнале EEPROM целиком
+{
+  uint8_t on_off;                         // состояние будильника, включен/нет
+  uint8_t mode;                           // режим работы будильника, AlarmMode
+  uint8_t window_mask;                    // битовая маска включенных промежутков
+  uint8_t melody;                         // номер мелодии пищалки
+  uint16_t duration;                      // продолжительность сигнала, секунд
+  AlarmWindow window[ALARM_WINDOW_COUNT]; // промежутки сигнализации
+};
+
+// блоки списка точек и записи журнала ставятся в очередь записи в EEPROM
+// целиком и должны в ней помещаться
+static_assert(EEPROM_QUEUE_SIZE >= EEPROM_QUEUE_BLOCK_HEADER + ALARM_LIST_BLOCK_SIZE,
+              "EEPROM_QUEUE_SIZE: не помещается список точек");
+static_assert(EEPROM_QUEUE_SIZE >= EEPROM_QUEUE_BLOCK_HEADER + EEPROM_JOURNAL_HEADER_SIZE +
+                                       sizeof(AlarmSettings) + EEPROM_JOURNAL_CRC_SIZE,
+              "EEPROM_QUEUE_SIZE: не помещается запись журнала настроек");
+
+#define ALARM_JOURNAL_SIZE (ALARM_JOURNAL_SLOT_COUNT * (EEPROM_JOURNAL_HEADER_SIZE + sizeof(AlarmSettings) + EEPROM_JOURNAL_CRC_SIZE))
+
+// области EEPROM при размещении по умолчанию (см. header_file.h) идут одна
+// за другой и не пересекаются между собой и с настройками часов (96..99)
+static_assert(ALARM_EEPROM_INDEX + ALARM_INTERVAL + sizeof(uint16_t) <= 96,
+              "ALARM_EEPROM_INDEX: настройки прежних версий заходят на настройки часов");
+static_assert(ALARM_LIST_EEPROM_INDEX >= 100 &&
+                  ALARM_LIST_EEPROM_INDEX + ALARM_LIST_BLOCK_SIZE <= ALARM_JOURNAL_EEPROM_INDEX,
+              "ALARM_LIST_EEPROM_INDEX: список точек заходит на журнал настроек");
+static_assert(ALARM_JOURNAL_EEPROM_INDEX + ALARM_JOURNAL_SIZE <= ALARM_DAYS_EEPROM_INDEX,
+              "ALARM_JOURNAL_EEPROM_INDEX: журнал настроек заходит на дни недели");
+static_assert(ALARM_DAYS_EEPROM_INDEX + ALARM_DAY_COUNT <= ALARM_HOLIDAYS_EEPROM_INDEX,
+              "ALARM_DAYS_EEPROM_INDEX: дни недели заходят на календарь исключений");
+#ifdef E2END
+static_assert(ALARM_HOLIDAYS_EEPROM_INDEX + ALARM_HOLIDAYS_SIZE <= E2END + 1,
+              "ALARM_HOLIDAYS_EEPROM_INDEX: календарь исключений не помещается в EEPROM");
+#endif
+
+struct AlarmDefaultConfig // размещение в EEPROM и набор возможностей будильника по умолчанию
+{
+  static constexpr uint16_t LIST_INDEX = ALARM_LIST_EEPROM_INDEX;       // индекс списка точек срабатывания в EEPROM
+  static constexpr uint16_t JOURNAL_INDEX = ALARM_JOURNAL_EEPROM_INDEX; // индекс журнала настроек в EEPROM
+  static constexpr uint16_t DAYS_INDEX = ALARM_DAYS_EEPROM_INDEX;       // индекс наборов промежутков по дням недели в EEPROM
+  static constexpr uint16_t HOLIDAYS_INDEX = ALARM_HOLIDAYS_EEPROM_INDEX; // индекс календаря исключений в EEPROM
+  static constexpr bool USE_POINT_LIST = true;                          // режим срабатывания по списку точек
+  static constexpr bool USE_LEGACY_IMPORT = true;                       // перенос настроек прежних версий прошивки
+};
+
+/*
+ * пины светодиодов и индекс настроек прежних версий задаются параметрами
+ * шаблона, поэтому запись на пины сводится к одной инструкции (см.
+ * fast_pin.h), а индексы в EEPROM - к константам; возможности, отключенные
+ * в Config, не попадают в прошивку, а для списка точек не резервируется
+ * память
+ */
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config = AlarmDefaultConfig>
 class SerialAlarm
 {
 private:
-  uint8_t red_pin;
-  uint8_t green_pin;
-  uint16_t eeprom_index;
   AlarmState state;
-  uint16_t next_point;
+  AlarmCursor next_point;
+  AlarmSettings settings; // настройки считываются из EEPROM один раз, в begin()
+  EepromJournal journal;  // журнал записей настроек в EEPROM
+  uint8_t schedule[(MAX_DATA + 1) / 8]; // битовая карта точек срабатывания всех промежутков, один бит на каждую минуту суток
+  uint16_t point_count;                 // количество точек срабатывания в сутках
+  uint8_t list_count;                   // количество точек в списке срабатывания
+  uint16_t point_list[(Config::USE_POINT_LIST) ? ALARM_LIST_SIZE : 1]; // список точек срабатывания, упорядоченный по возрастанию
+  uint32_t last_time;                   // время предыдущей проверки, секунд от начала суток
+  uint16_t trigger_delay;               // опоздание последнего срабатывания, секунд
+  uint16_t max_trigger_delay;           // максимальное опоздание срабатывания, секунд
+  uint16_t missed_count;                // количество пропущенных срабатываний
+  uint8_t update_flags;                 // флаги пакетного изменения настроек, AlarmUpdateFlag
+  uint8_t pending_flags;                // блоки, ждущие места в очереди записи в EEPROM, AlarmUpdateFlag
+  uint8_t days[ALARM_DAY_COUNT];        // наборы промежутков по дням недели, от воскресенья
+  uint8_t day;                          // текущий день недели, 0xFF - еще не задан
+  uint8_t active_mask;                  // промежутки, действующие в текущий день; в режиме списка 0 - список в этот день отключен
+  uint16_t date;                        // номер текущей даты в году, ALARM_NO_DATE - еще не задана
+  bool holiday;                         // флаг даты-исключения - сегодня будильник не срабатывает
+  uint8_t holidays[ALARM_HOLIDAYS_SIZE]; // календарь исключений, бит на дату; как и в EEPROM, 0 - дата отмечена
+
+  void readLegacySettings();
+
+  bool readSettingsV1();
+
+  void writeSettings();
+
+  bool checkSettings();
+
+  bool isListMode();
+
+  bool isWindowOn(uint8_t _window);
+
+  bool isWindowActive(uint8_t _window);
+
+  bool isListActive();
+
+  bool checkWindow(AlarmWindow &_wnd, uint16_t _time);
+
+  uint16_t calcWindowPoint(AlarmWindow &_wnd, uint16_t _time);
+
+  uint8_t findListIndex(uint16_t _time);
+
+  uint16_t calcNextPoint(uint32_t _time);
 
-  uint8_t read_eeprom_8(IndexOffset _index);
+  uint16_t getPointAfter(uint16_t _time);
 
-  uint16_t read_eeprom_16(IndexOffset _index);
+  uint16_t getPointBefore(uint16_t _time);
 
-  void write_eeprom_8(IndexOffset _index, uint8_t _data);
+  uint16_t countPointsFrom(uint16_t _time);
 
-  void write_eeprom_16(IndexOffset _index, uint16_t _data);
+  void readPointList();
 
-  void setNextPoint(uint16_t _time);
+  void writePointList();
+
+  void readDays();
+
+  void writeDays();
+
+  void readHolidays();
+
+  void writeHolidays();
 
   void setLed(uint16_t _time);
 
+  void fillSchedule();
+
+  void buildSchedule();
+
+  bool insertListPoint(uint16_t _time);
+
 public:
-  SerialAlarm(uint8_t _red_pin, uint8_t _green_pin, uint16_t _eeprom_index);
+  /**
+   * @brief конструктор будильника; пин красного светодиода RedPin, пин
+   *        зеленого светодиода GreenPin, индекс настроек прежних версий
+   *        прошивки в EEPROM EepromIndex (они переносятся в журнал, если в
+   *        нем еще нет записей), остальное - в Config
+   */
+  SerialAlarm();
+
+  /**
+   * @brief загрузка настроек будильника из EEPROM; блок настроек считывается
+   *        целиком и проверяется в памяти, исправленные значения записываются
+   *        обратно одной записью журнала; вызывается один раз в setup()
+   */
+  void begin();
 
   /**
    * @brief первоначальное определение точки следующего срабатывания будильника при включении или при изменении настроек будильника
    *
-   * @param _time текущее время
+   * @param _time текущее время в секундах от начала суток
+   */
+  void init(uint32_t _time);
+
+
+  /**
+   * @brief проверка, является ли минута точкой срабатывания будильника
+   *
+   * @param _time количество минут с начала суток
+   * @return true
+   * @return false
+   */
+  bool checkPoint(uint16_t _time);
+
+  /**
+   * @brief поиск ближайшей точки срабатывания, начиная с заданного момента
+   *        (включительно), с учетом перехода через полночь; для каждого
+   *        включенного промежутка выполняется за постоянное время, без
+   *        перебора точек, в режиме списка точка ищется двоичным поиском;
+   *        дальше по точкам плана дня можно идти вперед и назад функциями
+   *        nextPoint() и prevPoint(), без обращений к EEPROM
+   *
+   * @param _time время в секундах от начала суток
+   * @return AlarmCursor позиция точки; point == ALARM_NO_POINT, если точек
+   *         срабатывания нет
+   */
+  AlarmCursor seekPoint(uint32_t _time);
+
+  /**
+   * @brief переход к следующей точке срабатывания
+   *
+   * @param _cur позиция, полученная от seekPoint()
+   * @return true
+   * @return false переход через полночь - позиция установлена на первую
+   *         точку суток; false и при отсутствии точек
+   */
+  bool nextPoint(AlarmCursor &_cur);
+
+  /**
+   * @brief переход к предыдущей точке срабатывания
+   *
+   * @param _cur позиция, полученная от seekPoint()
+   * @return true
+   * @return false переход через полночь - позиция установлена на последнюю
+   *         точку суток; false и при отсутствии точек
+   */
+  bool prevPoint(AlarmCursor &_cur);
+
+
+  /**
+   * @brief поиск ближайшей после заданной минуты, в которую может смениться
+   *        цвет светодиода - начала или окончания любого включенного промежутка
+   *
+   * @param _time количество минут с начала суток
+   * @return uint16_t время в минутах от начала суток
+   */
+  uint16_t getNextEdge(uint16_t _time);
+
+  /**
+   * @brief получение времени до ближайшего события - срабатывания
+   *        будильника, смены цвета светодиода или смены плана дня в полночь
+   *
+   * @param _time текущее время в секундах от начала суток
+   * @return uint32_t время до события в секундах; 86400, если событий нет
+   */
+  uint32_t getTimeToEvent(uint32_t _time);
+
+  /**
+   * @brief управление светодиодом сработавшего будильника - мигание зеленым;
+   *        вызывается часто, при несработавшем будильнике ничего не делает
+   */
+  void blinkLed();
+
+  /**
+   * @brief получение количества точек срабатывания будильника в сутках
+   *
+   * @return uint16_t
+   */
+  uint16_t getPointCount();
+
+  /**
+   * @brief получение первой точки срабатывания - времени начала первого
+   *        включенного промежутка или первой точки списка
+   *
+   * @return uint16_t время в минутах от начала суток
+   */
+  uint16_t getFirstPoint();
+
+  /**
+   * @brief получение режима работы будильника
+   *
+   * @return AlarmMode
+   */
+  AlarmMode getAlarmMode();
+
+  /**
+   * @brief установка режима работы будильника; режим списка точек
+   *        недоступен, если он отключен в Config
+   *
+   * @param _mode новый режим
+   */
+  void setAlarmMode(AlarmMode _mode);
+
+  /**
+   * @brief получение количества точек в списке срабатывания
+   *
+   * @return uint8_t
+   */
+  uint8_t getListCount();
+
+  /**
+   * @brief получение точки из списка срабатывания
+   *
+   * @param _index номер точки в списке, 0..getListCount() - 1
+   * @return uint16_t время в минутах от начала суток
+   */
+  uint16_t getListPoint(uint8_t _index);
+
+  /**
+   * @brief установка списка точек срабатывания; точки упорядочиваются по
+   *        возрастанию, повторы и значения больше MAX_DATA отбрасываются
+   *
+   * @param _list массив точек в минутах от начала суток
+   * @param _count количество точек, не больше ALARM_LIST_SIZE
+   */
+  void setPointList(const uint16_t *_list, uint8_t _count);
+
+  /**
+   * @brief добавление точки в список срабатывания с сохранением порядка;
+   *        повторы отбрасываются
+   *
+   * @param _time время в минутах от полуночи
+   * @return true - точка добавлена или уже есть в списке
+   * @return false - недопустимое время или список заполнен
+   */
+  bool addListPoint(uint16_t _time);
+
+  /**
+   * @brief начало пакетного изменения настроек; до вызова endUpdate()
+   *        сеттеры меняют настройки только в памяти, а запись в EEPROM и
+   *        перестроение карты точек срабатывания откладываются
+   */
+  void beginUpdate();
+
+  /**
+   * @brief окончание пакетного изменения настроек - проверка настроек,
+   *        одна запись журнала и списка точек в EEPROM и одно перестроение
+   *        карты точек срабатывания; после него нужно вызвать init()
+   *
+   * @return true - настройки были изменены
+   * @return false - изменений не было
+   */
+  bool endUpdate();
+
+  /**
+   * @brief постановка в очередь записи в EEPROM блоков настроек, которым
+   *        при изменении не хватило в ней места; блок пишется целиком из
+   *        текущих настроек, поэтому несколько изменений, пришедшихся на
+   *        ожидание, дают одну запись; вызывается из loop()
+   */
+  void writePending();
+
+  /**
+   * @brief проверка наличия блоков настроек, ждущих места в очереди записи
+   *        в EEPROM
+   *
+   * @return true
+   * @return false
    */
-  void init(clkDateTime _time);
+  bool isWritePending();
 
   /**
    * @brief получение текущего состояния будильника
@@ -89,7 +473,8 @@ public:
   void setAlarmState(AlarmState _state);
 
   /**
-   * @brief проверка времени на вхождение в интервал
+   * @brief проверка времени на вхождение в любой из включенных промежутков,
+   *        в режиме списка - в промежуток от первой до последней точки
    *
    * @param _time количество минут с начала суток
    * @return true
@@ -112,245 +497,1383 @@ public:
    */
   void setOnOffAlarm(bool _state);
 
+  /**
+   * @brief получение информации о состоянии промежутка - включен/выключен
+   *
+   * @param _window номер промежутка, 0..ALARM_WINDOW_COUNT - 1
+   * @return true
+   * @return false
+   */
+  bool getOnOffWindow(uint8_t _window);
+
+  /**
+   * @brief включение/выключение промежутка; последний включенный промежуток
+   *        выключить нельзя - для этого нужно выключить будильник
+   *
+   * @param _window номер промежутка, 0..ALARM_WINDOW_COUNT - 1
+   * @param _state флаг для установки состояния промежутка
+   * @return true
+   * @return false попытка выключить последний включенный промежуток,
+   *         состояние не изменено
+   */
+  bool setOnOffWindow(uint8_t _window, bool _state);
+
+  /**
+   * @brief получение номера мелодии пищалки
+   *
+   * @return uint8_t номер мелодии, 0..BUZZER_MELODY_COUNT - 1
+   */
+  uint8_t getAlarmMelody();
+
+  /**
+   * @brief установка номера мелодии пищалки
+   *
+   * @param _melody номер мелодии, 0..BUZZER_MELODY_COUNT - 1
+   */
+  void setAlarmMelody(uint8_t _melody);
+
+  /**
+   * @brief получение продолжительности сигнала будильника
+   *
+   * @return uint16_t продолжительность в секундах
+   */
+  uint16_t getAlarmDuration();
+
+  /**
+   * @brief установка продолжительности сигнала будильника
+   *
+   * @param _duration продолжительность в секундах, 1..ALARM_MAX_DURATION
+   */
+  void setAlarmDuration(uint16_t _duration);
+
   /**
    * @brief получение времени следующего срабатывания будильника
    *
-   * @return uint16_t время следующего срабатывания в минутах от начала суток
+   * @return uint16_t время следующего срабатывания в минутах от начала суток;
+   *         ALARM_NO_POINT, если точек срабатывания нет
    */
   uint16_t getNextPoint();
 
+  /**
+   * @brief получение опоздания последнего срабатывания будильника
+   *        относительно точки срабатывания
+   *
+   * @return uint16_t опоздание в секундах
+   */
+  uint16_t getTriggerDelay();
+
+  /**
+   * @brief получение максимального опоздания срабатывания будильника с момента
+   *        включения
+   *
+   * @return uint16_t опоздание в секундах
+   */
+  uint16_t getMaxTriggerDelay();
+
+  /**
+   * @brief получение количества пропущенных срабатываний с момента включения;
+   *        пропущенными считаются точки, пришедшиеся на время звучания
+   *        предыдущего сигнала, и точки, пройденные одной проверкой вслед за
+   *        первой из них (например, после зависания)
+   *
+   * @return uint16_t
+   */
+  uint16_t getMissedCount();
+
   /**
    * @brief получение времени перехода будильника в активный режим
    *
+   * @param _window номер промежутка
    * @return uint16_t время в минутах от начала суток
    */
-  uint16_t getAlarmPoint1();
+  uint16_t getAlarmPoint1(uint8_t _window = 0);
 
   /**
    * @brief установка времени перехода будильника в активный режим
    *
    * @param _time время в минутах от начала суток
+   * @param _window номер промежутка
    */
-  void setAlarmPoint1(uint16_t _time);
+  void setAlarmPoint1(uint16_t _time, uint8_t _window = 0);
 
   /**
    * @brief получение времени перехода будильника в неактивный режим
    *
+   * @param _window номер промежутка
    * @return uint16_t время в минутах от начала суток
    */
-  uint16_t getAlarmPoint2();
+  uint16_t getAlarmPoint2(uint8_t _window = 0);
 
   /**
    * @brief установка времени перехода будильника в неактивный режим
    *
    * @param _time время в минутах от начала суток
+   * @param _window номер промежутка
    */
-  void setAlarmPoint2(uint16_t _time);
+  void setAlarmPoint2(uint16_t _time, uint8_t _window = 0);
 
   /**
    * @brief получение действующего интервала срабатывания будильника (минут)
    *
+   * @param _window номер промежутка
    * @return uint16_t
    */
-  uint16_t getAlarmInterval();
+  uint16_t getAlarmInterval(uint8_t _window = 0);
 
   /**
    * @brief установка интервала срабатывания будильника
    *
    * @param _time устанавливаемый интервал в минутах
+   * @param _window номер промежутка
    */
-  void setAlarmInterval(uint8_t _time);
+  void setAlarmInterval(uint8_t _time, uint8_t _window = 0);
 
   /**
-   * @brief проверка текущего состояния будильника
+   * @brief получение набора промежутков, действующих в день недели
    *
-   * @param _time текущее время
+   * @param _day день недели, 0 - воскресенье
+   * @return uint8_t битовая маска промежутков; в режиме списка 0 - список
+   *         в этот день отключен
    */
-  void tick(clkDateTime _time);
-};
+  uint8_t getDayWindows(uint8_t _day);
 
-// ---- private ---------------------------------
+  /**
+   * @brief установка набора промежутков, действующих в день недели
+   *
+   * @param _day день недели, 0 - воскресенье
+   * @param _mask битовая маска промежутков; 0 - в этот день будильник не
+   *        срабатывает
+   */
+  void setDayWindows(uint8_t _day, uint8_t _mask);
 
-uint8_t SerialAlarm::read_eeprom_8(IndexOffset _index)
-{
-  return (EEPROM.read(eeprom_index + _index));
-}
+  /**
+   * @brief проверка, отмечена ли дата в календаре исключений
+   *
+   * @param _date номер даты в году, 0..365
+   * @return true
+   * @return false
+   */
+  bool isHoliday(uint16_t _date);
 
-uint16_t SerialAlarm::read_eeprom_16(IndexOffset _index)
-{
-  uint16_t _data;
-  EEPROM.get(eeprom_index + _index, _data);
-  return (_data);
-}
+  /**
+   * @brief отметка даты в календаре исключений или снятие отметки
+   *
+   * @param _date номер даты в году, 0..365
+   * @param _on true - в эту дату будильник не срабатывает
+   * @return true
+   * @return false такой даты нет, календарь не изменен
+   */
+  bool setHoliday(uint16_t _date, bool _on);
 
-void SerialAlarm::write_eeprom_8(IndexOffset _index, uint8_t _data)
-{
-  EEPROM.update(eeprom_index + _index, _data);
-}
+  /**
+   * @brief очистка календаря исключений
+   */
+  void clearHolidays();
 
-void SerialAlarm::write_eeprom_16(IndexOffset _index, uint16_t _data)
-{
-  EEPROM.put(eeprom_index + _index, _data);
-}
+  /**
+   * @brief установка текущего дня недели и даты; вызывается перед каждой
+   *        проверкой будильника, план дня перестраивается только при смене
+   *        дня - в полночь или после изменения даты; только в этот момент
+   *        проверяется и календарь исключений
+   *
+   * @param _day день недели, 0 - воскресенье; 7 тоже считается воскресеньем
+   * @param _date номер даты в году, 0..365
+   */
+  void setDay(uint8_t _day, uint16_t _date);
 
-void SerialAlarm::setNextPoint(uint16_t _time)
-{
-  next_point = (_time < MAX_DATA + 1) ? _time : _time - (MAX_DATA + 1);
-}
+  /**
+   * @brief проверка текущего состояния будильника; будильник срабатывает,
+   *        если точка срабатывания оказалась между предыдущей и текущей
+   *        проверками, поэтому опоздавшая проверка не приводит к пропуску
+   *        сигнала
+   *
+   * @param _time текущее время в секундах от начала суток
+   */
+  void tick(uint32_t _time);
+};
 
-bool SerialAlarm::checkForInterval(uint16_t &_time)
-{
-  uint16_t p1 = getAlarmPoint1();
-  uint16_t p2 = getAlarmPoint2();
+// ---- private ---------------------------------
 
-  if (_time >= MAX_DATA + 1)
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::readLegacySettings()
+{
+  // прежние версии прошивки хранили только один промежуток; остальные поля
+  // заполняются недопустимыми значениями и получат значения по умолчанию при
+  // проверке
+  memset(&settings, 0xFF, sizeof(AlarmSettings));
+  if (!Config::USE_LEGACY_IMPORT)
   {
-    _time -= MAX_DATA + 1;
+    return;
   }
+  settings.on_off = saEepromQueue.read(EepromIndex + ALARM_STATE);
+  saEepromQueue.get(EepromIndex + ALARM_POINT_1, settings.window[0].point_1);
+  saEepromQueue.get(EepromIndex + ALARM_POINT_2, settings.window[0].point_2);
+  saEepromQueue.get(EepromIndex + ALARM_INTERVAL, settings.window[0].interval);
+}
 
-  if (p1 == p2)
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::readSettingsV1()
+{
+  // мелодия и продолжительность сигнала получат значения по умолчанию при
+  // проверке; поля переносятся по смещениям, т.к. в памяти компьютера
+  // промежутки выравниваются иначе, чем в EEPROM
+  if (!Config::USE_LEGACY_IMPORT)
   {
     return (false);
   }
-
-  if (p2 > p1)
-  {
-    return ((_time >= p1) && (_time < p2));
-  }
-  else
+  uint8_t x[ALARM_SETTINGS_V1_SIZE];
+  EepromJournal v1(Config::JOURNAL_INDEX, ALARM_JOURNAL_SLOT_COUNT, ALARM_SETTINGS_V1_SIZE, 1);
+  if (!v1.load(x))
   {
-    return ((_time >= p1) || (_time < p2));
+    return (false);
   }
+
+  memset(&settings, 0xFF, sizeof(AlarmSettings));
+  settings.on_off = x[0];
+  settings.mode = x[1];
+  settings.window_mask = x[2];
+  memcpy(settings.window, &x[3], sizeof(settings.window));
+
+  return (true);
 }
 
-void SerialAlarm::setLed(uint16_t _time)
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::writeSettings()
 {
-  static uint8_t n = 0;
-  uint8_t red_state = LOW;
-  uint8_t green_state = LOW;
-  if (state == ALARM_YES)
-  { // при сработавшем будильнике светодиод мигает зеленым с периодом 0.2 секунды
-    green_state = n;
-    if (++n > 1)
-    {
-      n = 0;
-    }
-  }
-  else if (state)
+  if (update_flags)
   {
-    (checkForInterval(_time)) ? green_state = HIGH : red_state = HIGH;
+    update_flags |= ALARM_UPDATE_SETTINGS;
+    return;
+  }
+  if (!saEepromQueue.hasRoom(journal.getRecordSize()))
+  { // запись подождет места в очереди, см. writePending()
+    pending_flags |= ALARM_UPDATE_SETTINGS;
+    return;
   }
-  digitalWrite(red_pin, red_state);
-  digitalWrite(green_pin, green_state);
+  pending_flags &= ~ALARM_UPDATE_SETTINGS;
+  journal.save(&settings);
 }
 
-// ---- public ----------------------------------
-
-SerialAlarm::SerialAlarm(uint8_t _red_pin, uint8_t _green_pin, uint16_t _eeprom_index)
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::checkSettings()
 {
-  red_pin = _red_pin;
-  pinMode(red_pin, OUTPUT);
-  green_pin = _green_pin;
-  pinMode(green_pin, OUTPUT);
-  eeprom_index = _eeprom_index;
-  if (read_eeprom_8(ALARM_STATE) > 1)
-  {
-    write_eeprom_8(ALARM_STATE, 0);
-  }
-  if (read_eeprom_16(ALARM_POINT_1) > MAX_DATA)
+  bool result = false;
+
+  if (settings.on_off > 1)
   {
-    write_eeprom_16(ALARM_POINT_1, (uint16_t)8 * 60);
+    settings.on_off = 0;
+    result = true;
   }
-  if (read_eeprom_16(ALARM_POINT_2) > MAX_DATA)
+  if ((settings.mode > ALARM_MODE_LIST) ||
+      (!Config::USE_POINT_LIST && settings.mode == ALARM_MODE_LIST))
   {
-    write_eeprom_16(ALARM_POINT_2, 17 * 60 + 1);
+    settings.mode = ALARM_MODE_INTERVAL;
+    result = true;
   }
-  if ((read_eeprom_16(ALARM_INTERVAL) > MAX_INTERVAL) ||
-      (read_eeprom_16(ALARM_INTERVAL) < MIN_INTERVAL))
-  {
-    write_eeprom_16(ALARM_INTERVAL, 60);
+  if ((settings.window_mask >= (1 << ALARM_WINDOW_COUNT)) ||
+      (settings.window_mask == 0))
+  { // по умолчанию включен только первый промежуток
+    settings.window_mask = 0x01;
+    result = true;
   }
-  state = (AlarmState)read_eeprom_8(ALARM_STATE);
-}
-
-void SerialAlarm::init(clkDateTime _time)
-{
-  uint16_t p1 = getAlarmPoint1();
-  uint16_t p2 = getAlarmPoint2();
-
-  uint32_t tm = _time.hour() * 3600ul + _time.minute() * 60ul + _time.second();
-  if (p2 < p1)
+  if (settings.melody >= BUZZER_MELODY_COUNT)
   {
-    tm += (MAX_DATA + 1) * 60ul;
+    settings.melody = 0;
+    result = true;
   }
-
-  uint16_t x = p1;
-  uint16_t it = getAlarmInterval();
-
-  while (x * 60ul < tm)
+  if ((settings.duration > ALARM_MAX_DURATION) ||
+      (settings.duration == 0))
   {
-    x += it;
+    settings.duration = ALARM_DURATION;
+    result = true;
   }
-  if (!checkForInterval(x))
+  for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
   {
-    x = p1;
-  }
+    AlarmWindow &wnd = settings.window[i];
 
-  setNextPoint(x);
-}
+    if (wnd.point_1 > MAX_DATA)
+    {
+      wnd.point_1 = (uint16_t)8 * 60;
+      result = true;
+    }
+    if (wnd.point_2 > MAX_DATA)
+    {
+      wnd.point_2 = 17 * 60 + 1;
+      result = true;
+    }
+    if ((wnd.interval > MAX_INTERVAL) ||
+        (wnd.interval < MIN_INTERVAL))
+    {
+      wnd.interval = 60;
+      result = true;
+    }
+  }
+
+  return (result);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::isListMode()
+{
+  return (Config::USE_POINT_LIST && settings.mode == ALARM_MODE_LIST);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::isWindowOn(uint8_t _window)
+{
+  return (settings.window_mask & (1 << _window));
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::isWindowActive(uint8_t _window)
+{
+  return (active_mask & (1 << _window));
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::isListActive()
+{
+  return (list_count && active_mask);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::checkWindow(AlarmWindow &_wnd, uint16_t _time)
+{
+  if (_wnd.point_1 == _wnd.point_2)
+  {
+    return (false);
+  }
+
+  if (_wnd.point_2 > _wnd.point_1)
+  {
+    return ((_time >= _wnd.point_1) && (_time < _wnd.point_2));
+  }
+  else
+  {
+    return ((_time >= _wnd.point_1) || (_time < _wnd.point_2));
+  }
+}
 
-AlarmState SerialAlarm::getAlarmState() { return (state); }
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::calcWindowPoint(AlarmWindow &_wnd, uint16_t _time)
+{
+  uint16_t p1 = _wnd.point_1;
+  // длина промежутка в минутах; при p1 == p2 длина нулевая и единственной
+  // точкой срабатывания остается p1
+  uint16_t len = (_wnd.point_2 + (MAX_DATA + 1) - p1) % (MAX_DATA + 1);
+  // смещение от начала промежутка с учетом перехода через полночь
+  uint16_t offset = (_time + (MAX_DATA + 1) - p1) % (MAX_DATA + 1);
 
-void SerialAlarm::setAlarmState(AlarmState _state) { state = _state; }
+  if (offset < len)
+  {
+    uint16_t it = _wnd.interval;
+    offset = (offset + it - 1) / it * it;
+    if (offset < len)
+    {
+      p1 += offset;
+      return ((p1 < MAX_DATA + 1) ? p1 : p1 - (MAX_DATA + 1));
+    }
+  }
 
-bool SerialAlarm::getOnOffAlarm() { return (bool)read_eeprom_8(ALARM_STATE); }
+  return (p1);
+}
 
-void SerialAlarm::setOnOffAlarm(bool _state)
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint8_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::findListIndex(uint16_t _time)
 {
-  write_eeprom_8(ALARM_STATE, (uint8_t)_state);
+  // двоичный поиск первой точки списка, не меньшей _time
+  uint8_t lo = 0;
+  uint8_t hi = list_count;
+  while (lo < hi)
+  {
+    uint8_t mid = (lo + hi) >> 1;
+    (point_list[mid] < _time) ? lo = mid + 1 : hi = mid;
+  }
+
+  return (lo);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::readPointList()
+{
+  uint16_t index = Config::LIST_INDEX;
+  list_count = saEepromQueue.read(index++);
+  if (!Config::USE_POINT_LIST || list_count > ALARM_LIST_SIZE)
+  {
+    list_count = 0;
+  }
+
+  uint16_t x = 0;
+  for (uint8_t i = 0; i < list_count; i++)
+  {
+    uint16_t d;
+    if (i == 0)
+    {
+      saEepromQueue.get(index, d);
+      index += 2;
+    }
+    else
+    {
+      d = saEepromQueue.read(index++);
+      if (d & 0x80)
+      {
+        d = ((d & 0x7F) << 8) | saEepromQueue.read(index++);
+      }
+    }
+    x += d;
+    // точки должны строго возрастать, иначе список считается испорченным
+    if ((x > MAX_DATA) || (i > 0 && d == 0))
+    {
+      list_count = 0;
+      writePointList();
+      break;
+    }
+    point_list[i] = x;
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::writePointList()
+{
+  if (update_flags)
+  {
+    update_flags |= ALARM_UPDATE_LIST;
+    return;
+  }
+  if (!Config::USE_POINT_LIST)
+  {
+    return;
+  }
+  if (!saEepromQueue.hasRoom(ALARM_LIST_BLOCK_SIZE))
+  {
+    pending_flags |= ALARM_UPDATE_LIST;
+    return;
+  }
+  pending_flags &= ~ALARM_UPDATE_LIST;
+
+  uint16_t index = Config::LIST_INDEX;
+  saEepromQueue.write(index++, list_count);
+  for (uint8_t i = 0; i < list_count; i++)
+  {
+    if (i == 0)
+    {
+      saEepromQueue.put(index, point_list[0]);
+      index += 2;
+    }
+    else
+    {
+      uint16_t d = point_list[i] - point_list[i - 1];
+      if (d >= 0x80)
+      {
+        saEepromQueue.write(index++, 0x80 | (d >> 8));
+      }
+      saEepromQueue.write(index++, d & 0xFF);
+    }
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::readDays()
+{
+  for (uint8_t i = 0; i < ALARM_DAY_COUNT; i++)
+  {
+    days[i] = saEepromQueue.read(Config::DAYS_INDEX + i);
+    if (days[i] > ALARM_ALL_WINDOWS)
+    {
+      days[i] = ALARM_ALL_WINDOWS;
+    }
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::writeDays()
+{
+  if (update_flags)
+  {
+    update_flags |= ALARM_UPDATE_DAYS;
+    return;
+  }
+  if (!saEepromQueue.hasRoom(ALARM_DAY_COUNT))
+  {
+    pending_flags |= ALARM_UPDATE_DAYS;
+    return;
+  }
+  pending_flags &= ~ALARM_UPDATE_DAYS;
+
+  for (uint8_t i = 0; i < ALARM_DAY_COUNT; i++)
+  {
+    saEepromQueue.write(Config::DAYS_INDEX + i, days[i]);
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::readHolidays()
+{
+  for (uint8_t i = 0; i < ALARM_HOLIDAYS_SIZE; i++)
+  {
+    holidays[i] = saEepromQueue.read(Config::HOLIDAYS_INDEX + i);
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::writeHolidays()
+{
+  if (update_flags)
+  {
+    update_flags |= ALARM_UPDATE_HOLIDAYS;
+    return;
+  }
+
+  // записывается одним блоком только участок от первого до последнего
+  // измененного байта - обычно это один байт
+  uint8_t first = ALARM_HOLIDAYS_SIZE;
+  uint8_t last = 0;
+  for (uint8_t i = 0; i < ALARM_HOLIDAYS_SIZE; i++)
+  {
+    if (saEepromQueue.read(Config::HOLIDAYS_INDEX + i) != holidays[i])
+    {
+      if (first == ALARM_HOLIDAYS_SIZE)
+      {
+        first = i;
+      }
+      last = i;
+    }
+  }
+  if (first < ALARM_HOLIDAYS_SIZE && !saEepromQueue.hasRoom(last - first + 1))
+  {
+    pending_flags |= ALARM_UPDATE_HOLIDAYS;
+    return;
+  }
+  pending_flags &= ~ALARM_UPDATE_HOLIDAYS;
+
+  for (uint8_t i = first; i <= last && i < ALARM_HOLIDAYS_SIZE; i++)
+  {
+    saEepromQueue.write(Config::HOLIDAYS_INDEX + i, holidays[i]);
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setLed(uint16_t _time)
+{
+  if (state == ALARM_YES)
+  { // миганием сработавшего будильника управляет blinkLed()
+    return;
+  }
+
+  uint8_t red_state = LOW;
+  uint8_t green_state = LOW;
+  if (state)
+  {
+    (checkForInterval(_time)) ? green_state = HIGH : red_state = HIGH;
+  }
+  FastPin<RedPin>::write(red_state);
+  FastPin<GreenPin>::write(green_state);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::fillSchedule()
+{
+  memset(schedule, 0, sizeof(schedule));
+  point_count = 0;
+  // пока день недели не задан, действуют все включенные промежутки
+  uint8_t mask = (day < ALARM_DAY_COUNT) ? days[day] : ALARM_ALL_WINDOWS;
+  if (holiday)
+  {
+    mask = 0;
+  }
+  active_mask = (isListMode()) ? mask : settings.window_mask & mask;
+
+  if (isListMode())
+  {
+    if (!isListActive())
+    {
+      return;
+    }
+    for (uint8_t i = 0; i < list_count; i++)
+    {
+      schedule[point_list[i] >> 3] |= 1 << (point_list[i] & 0x07);
+    }
+    point_count = list_count;
+    return;
+  }
+
+  for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
+  {
+    if (!isWindowActive(i))
+    {
+      continue;
+    }
+
+    uint16_t p1 = settings.window[i].point_1;
+    uint16_t len = (settings.window[i].point_2 + (MAX_DATA + 1) - p1) % (MAX_DATA + 1);
+    if (len == 0)
+    { // однократное срабатывание
+      len = 1;
+    }
+    for (uint16_t x = 0; x < len; x += settings.window[i].interval)
+    {
+      uint16_t y = p1 + x;
+      if (y > MAX_DATA)
+      {
+        y -= MAX_DATA + 1;
+      }
+      if (!checkPoint(y))
+      { // точки разных промежутков могут совпадать
+        schedule[y >> 3] |= 1 << (y & 0x07);
+        point_count++;
+      }
+    }
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::buildSchedule()
+{
+  if (update_flags)
+  {
+    update_flags |= ALARM_UPDATE_SCHEDULE;
+    return;
+  }
+
+  fillSchedule();
+  // ближайшая точка ищется уже по новому плану, начиная со следующей после
+  // предыдущей проверки секунды
+  next_point = seekPoint((last_time + 1) % 86400ul);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::insertListPoint(uint16_t _time)
+{
+  uint8_t k = findListIndex(_time);
+  if (k < list_count && point_list[k] == _time)
+  { // такая точка уже есть
+    return (true);
+  }
+  if (!Config::USE_POINT_LIST || _time > MAX_DATA || list_count >= ALARM_LIST_SIZE)
+  {
+    return (false);
+  }
+
+  memmove(&point_list[k + 1], &point_list[k], (list_count - k) * sizeof(uint16_t));
+  point_list[k] = _time;
+  list_count++;
+
+  return (true);
+}
+
+// ---- public ----------------------------------
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::SerialAlarm()
+    : journal(Config::JOURNAL_INDEX, ALARM_JOURNAL_SLOT_COUNT, sizeof(AlarmSettings), ALARM_SETTINGS_VERSION)
+{
+  FastPin<RedPin>::setOutput();
+  FastPin<GreenPin>::setOutput();
+  state = ALARM_OFF;
+  next_point.point = ALARM_NO_POINT;
+  next_point.left = 0;
+  point_count = 0;
+  list_count = 0;
+  last_time = 0;
+  trigger_delay = 0;
+  max_trigger_delay = 0;
+  missed_count = 0;
+  update_flags = 0;
+  pending_flags = 0;
+  memset(days, ALARM_ALL_WINDOWS, sizeof(days));
+  day = 0xFF;
+  active_mask = 0;
+  date = ALARM_NO_DATE;
+  holiday = false;
+  memset(holidays, 0xFF, sizeof(holidays));
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::begin()
+{
+  // запись журнала защищена CRC, но значения все равно проверяются - они
+  // могли быть перенесены из настроек прежних версий прошивки
+  bool changed = !journal.load(&settings);
+  if (changed && !readSettingsV1())
+  {
+    readLegacySettings();
+  }
+  if (checkSettings() || changed)
+  {
+    writeSettings();
+  }
+
+  readPointList();
+  readDays();
+  readHolidays();
+  state = (AlarmState)settings.on_off;
+  buildSchedule();
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::init(uint32_t _time)
+{
+  next_point = seekPoint(_time);
+  // точка, приходящаяся на текущую секунду, еще не отработана, поэтому
+  // предыдущей проверкой считается предыдущая секунда
+  last_time = (_time) ? _time - 1 : 86399ul;
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::calcNextPoint(uint32_t _time)
+{
+  // минута, с которой начинается поиск, с округлением вверх - точка,
+  // приходящаяся на текущую секунду, еще не отработана
+  uint16_t tm = (_time + 59) / 60;
+  if (tm > MAX_DATA)
+  {
+    tm -= MAX_DATA + 1;
+  }
+
+  if (isListMode())
+  {
+    if (!isListActive())
+    {
+      return (tm);
+    }
+    uint8_t i = findListIndex(tm);
+    return (point_list[(i < list_count) ? i : 0]);
+  }
+
+  uint16_t result = tm;
+  uint16_t dist = MAX_DATA + 1;
+  for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
+  {
+    if (isWindowActive(i))
+    {
+      uint16_t x = calcWindowPoint(settings.window[i], tm);
+      uint16_t d = (x + (MAX_DATA + 1) - tm) % (MAX_DATA + 1);
+      if (d < dist)
+      {
+        dist = d;
+        result = x;
+      }
+    }
+  }
+
+  return (result);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::checkPoint(uint16_t _time)
+{
+  return (schedule[_time >> 3] & (1 << (_time & 0x07)));
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getPointAfter(uint16_t _time)
+{
+  uint16_t x = _time;
+  for (uint16_t i = 0; i <= MAX_DATA;)
+  {
+    if (++x > MAX_DATA)
+    {
+      x = 0;
+    }
+    uint8_t b = schedule[x >> 3] >> (x & 0x07);
+    if (b & 0x01)
+    {
+      return (x);
+    }
+    if (b == 0)
+    { // до конца байта точек нет, переходим сразу к следующему
+      uint8_t step = 7 - (x & 0x07);
+      x += step;
+      i += step;
+    }
+    i++;
+  }
+
+  return (_time);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getPointBefore(uint16_t _time)
+{
+  uint16_t x = _time;
+  for (uint16_t i = 0; i <= MAX_DATA;)
+  {
+    x = (x) ? x - 1 : MAX_DATA;
+    // бит минуты x становится старшим, биты следующих за ней минут отбрасываются
+    uint8_t b = schedule[x >> 3] << (7 - (x & 0x07));
+    if (b & 0x80)
+    {
+      return (x);
+    }
+    if (b == 0)
+    { // до начала байта точек нет, переходим сразу к предыдущему
+      uint8_t step = x & 0x07;
+      x -= step;
+      i += step;
+    }
+    i++;
+  }
+
+  return (_time);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::countPointsFrom(uint16_t _time)
+{
+  uint16_t result = 0;
+  uint8_t i = _time >> 3;
+  uint8_t b = schedule[i] >> (_time & 0x07);
+  while (true)
+  {
+    for (; b; b &= b - 1)
+    {
+      result++;
+    }
+    if (++i >= sizeof(schedule))
+    {
+      return (result);
+    }
+    b = schedule[i];
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+AlarmCursor SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::seekPoint(uint32_t _time)
+{
+  AlarmCursor result = {ALARM_NO_POINT, 0};
+  if (point_count)
+  {
+    result.point = calcNextPoint(_time);
+    result.left = countPointsFrom(result.point);
+  }
+
+  return (result);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::nextPoint(AlarmCursor &_cur)
+{
+  if (_cur.point == ALARM_NO_POINT)
+  {
+    return (false);
+  }
+
+  uint16_t x = getPointAfter(_cur.point);
+  bool result = (x > _cur.point);
+  _cur.left = (result) ? _cur.left - 1 : point_count;
+  _cur.point = x;
+
+  return (result);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::prevPoint(AlarmCursor &_cur)
+{
+  if (_cur.point == ALARM_NO_POINT)
+  {
+    return (false);
+  }
+
+  uint16_t x = getPointBefore(_cur.point);
+  bool result = (x < _cur.point);
+  _cur.left = (result) ? _cur.left + 1 : 1;
+  _cur.point = x;
+
+  return (result);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getNextEdge(uint16_t _time)
+{
+  uint16_t edge[ALARM_WINDOW_COUNT * 2];
+  uint8_t count = 0;
+  if (isListMode())
+  {
+    if (isListActive())
+    {
+      edge[count++] = point_list[0];
+      edge[count++] = point_list[list_count - 1] + 1;
+    }
+  }
+  else
+  {
+    for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
+    {
+      if (isWindowActive(i))
+      {
+        edge[count++] = settings.window[i].point_1;
+        edge[count++] = settings.window[i].point_2;
+      }
+    }
+  }
+
+  // расстояние считается строго после _time, в пределах 1..MAX_DATA + 1 минут
+  uint16_t dist = MAX_DATA + 1;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    uint16_t d = (edge[i] + (MAX_DATA + 1) * 2 - _time - 1) % (MAX_DATA + 1) + 1;
+    if (d < dist)
+    {
+      dist = d;
+    }
+  }
+
+  return ((_time + dist) % (MAX_DATA + 1));
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint32_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getTimeToEvent(uint32_t _time)
+{
+  uint32_t result = 86400ul;
+  if (state != ALARM_OFF)
+  {
+    uint32_t x = (getNextEdge(_time / 60) * 60ul + 86400ul - _time) % 86400ul;
+    if (x < result)
+    {
+      result = x;
+    }
+  }
+  if (state == ALARM_ON && next_point.point != ALARM_NO_POINT)
+  {
+    uint32_t x = (next_point.point * 60ul + 86400ul - _time) % 86400ul;
+    if (x < result)
+    {
+      result = x;
+    }
+  }
+  if (state != ALARM_OFF && day < ALARM_DAY_COUNT && 86400ul - _time < result)
+  { // в полночь план дня сменится, и ближайшее событие нужно искать заново
+    result = 86400ul - _time;
+  }
+
+  return (result);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::blinkLed()
+{
+  if (state == ALARM_YES)
+  { // светодиод мигает зеленым с периодом 0.2 секунды
+    FastPin<RedPin>::write(LOW);
+    FastPin<GreenPin>::write((millis() / 200) & 0x01);
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getPointCount() { return (point_count); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getFirstPoint()
+{
+  if (isListMode())
+  {
+    return ((isListActive()) ? point_list[0] : 0);
+  }
+
+  for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
+  {
+    if (isWindowActive(i))
+    {
+      return (settings.window[i].point_1);
+    }
+  }
+
+  return (0);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+AlarmMode SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getAlarmMode() { return ((AlarmMode)settings.mode); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setAlarmMode(AlarmMode _mode)
+{
+  if (!Config::USE_POINT_LIST && _mode == ALARM_MODE_LIST)
+  {
+    return;
+  }
+  if (settings.mode != (uint8_t)_mode)
+  {
+    settings.mode = (uint8_t)_mode;
+    writeSettings();
+    buildSchedule();
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint8_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getListCount() { return (list_count); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getListPoint(uint8_t _index) { return (point_list[_index]); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setPointList(const uint16_t *_list, uint8_t _count)
+{
+  if (_count > ALARM_LIST_SIZE)
+  {
+    _count = ALARM_LIST_SIZE;
+  }
+
+  // вставка каждой точки на свое место с отбрасыванием повторов
+  list_count = 0;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    insertListPoint(_list[i]);
+  }
+
+  writePointList();
+  buildSchedule();
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::addListPoint(uint16_t _time)
+{
+  if (!insertListPoint(_time))
+  {
+    return (false);
+  }
+
+  writePointList();
+  buildSchedule();
+  return (true);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::beginUpdate() { update_flags = ALARM_UPDATE_ACTIVE; }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::endUpdate()
+{
+  uint8_t flags = update_flags;
+  update_flags = 0;
+
+  if (checkSettings())
+  {
+    flags |= ALARM_UPDATE_SETTINGS | ALARM_UPDATE_SCHEDULE;
+  }
+  if (flags & ALARM_UPDATE_SETTINGS)
+  {
+    writeSettings();
+  }
+  if (flags & ALARM_UPDATE_LIST)
+  {
+    writePointList();
+  }
+  if (flags & ALARM_UPDATE_DAYS)
+  {
+    writeDays();
+  }
+  if (flags & ALARM_UPDATE_HOLIDAYS)
+  {
+    writeHolidays();
+  }
+  if (flags & ALARM_UPDATE_SCHEDULE)
+  {
+    buildSchedule();
+  }
+
+  return (flags & ~ALARM_UPDATE_ACTIVE);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::writePending()
+{
+  // во время пакетного изменения блоки все равно будут записаны в endUpdate()
+  if (!pending_flags || update_flags)
+  {
+    return;
+  }
+  if (pending_flags & ALARM_UPDATE_SETTINGS)
+  {
+    writeSettings();
+  }
+  if (pending_flags & ALARM_UPDATE_LIST)
+  {
+    writePointList();
+  }
+  if (pending_flags & ALARM_UPDATE_DAYS)
+  {
+    writeDays();
+  }
+  if (pending_flags & ALARM_UPDATE_HOLIDAYS)
+  {
+    writeHolidays();
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::isWritePending() { return (pending_flags); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+AlarmState SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getAlarmState() { return (state); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setAlarmState(AlarmState _state) { state = _state; }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::checkForInterval(uint16_t &_time)
+{
+  if (_time >= MAX_DATA + 1)
+  {
+    _time -= MAX_DATA + 1;
+  }
+
+  if (isListMode())
+  {
+    return (isListActive() &&
+            _time >= point_list[0] &&
+            _time <= point_list[list_count - 1]);
+  }
+
+  for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
+  {
+    if (isWindowActive(i) && checkWindow(settings.window[i], _time))
+    {
+      return (true);
+    }
+  }
+
+  return (false);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getOnOffAlarm() { return (bool)settings.on_off; }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setOnOffAlarm(bool _state)
+{
+  if (settings.on_off != (uint8_t)_state)
+  {
+    settings.on_off = (uint8_t)_state;
+    writeSettings();
+  }
   state = (AlarmState)_state;
 }
 
-uint16_t SerialAlarm::getNextPoint() { return next_point; }
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getOnOffWindow(uint8_t _window) { return (isWindowOn(_window)); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setOnOffWindow(uint8_t _window, bool _state)
+{
+  uint8_t mask = (_state) ? settings.window_mask | (1 << _window)
+                          : settings.window_mask & ~(1 << _window);
+  if (mask == 0)
+  {
+    return (false);
+  }
+  if (mask != settings.window_mask)
+  {
+    settings.window_mask = mask;
+    writeSettings();
+    buildSchedule();
+  }
+
+  return (true);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint8_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getAlarmMelody() { return (settings.melody); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setAlarmMelody(uint8_t _melody)
+{
+  if (_melody < BUZZER_MELODY_COUNT && settings.melody != _melody)
+  {
+    settings.melody = _melody;
+    writeSettings();
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getAlarmDuration() { return (settings.duration); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setAlarmDuration(uint16_t _duration)
+{
+  _duration = constrain(_duration, 1, ALARM_MAX_DURATION);
+  if (settings.duration != _duration)
+  {
+    settings.duration = _duration;
+    writeSettings();
+  }
+}
 
-uint16_t SerialAlarm::getAlarmPoint1() { return (read_eeprom_16(ALARM_POINT_1)); }
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getNextPoint() { return (next_point.point); }
 
-void SerialAlarm::setAlarmPoint1(uint16_t _time) { write_eeprom_16(ALARM_POINT_1, _time); }
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getTriggerDelay() { return (trigger_delay); }
 
-uint16_t SerialAlarm::getAlarmPoint2() { return (read_eeprom_16(ALARM_POINT_2)); }
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getMaxTriggerDelay() { return (max_trigger_delay); }
 
-void SerialAlarm::setAlarmPoint2(uint16_t _time) { write_eeprom_16(ALARM_POINT_2, _time); }
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getMissedCount() { return (missed_count); }
 
-uint16_t SerialAlarm::getAlarmInterval() { return (read_eeprom_16(ALARM_INTERVAL)); }
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getAlarmPoint1(uint8_t _window) { return (settings.window[_window].point_1); }
 
-void SerialAlarm::setAlarmInterval(uint8_t _time)
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setAlarmPoint1(uint16_t _time, uint8_t _window)
+{
+  if (settings.window[_window].point_1 != _time)
+  {
+    settings.window[_window].point_1 = _time;
+    writeSettings();
+    buildSchedule();
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getAlarmPoint2(uint8_t _window) { return (settings.window[_window].point_2); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setAlarmPoint2(uint16_t _time, uint8_t _window)
+{
+  if (settings.window[_window].point_2 != _time)
+  {
+    settings.window[_window].point_2 = _time;
+    writeSettings();
+    buildSchedule();
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint16_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getAlarmInterval(uint8_t _window) { return (settings.window[_window].interval); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setAlarmInterval(uint8_t _time, uint8_t _window)
 {
   if (_time > 180)
   {
     _time = 180;
   }
-  write_eeprom_16(ALARM_INTERVAL, _time);
+  if (settings.window[_window].interval != _time)
+  {
+    settings.window[_window].interval = _time;
+    writeSettings();
+    buildSchedule();
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+uint8_t SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::getDayWindows(uint8_t _day) { return (days[_day]); }
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setDayWindows(uint8_t _day, uint8_t _mask)
+{
+  _mask &= ALARM_ALL_WINDOWS;
+  if (days[_day] != _mask)
+  {
+    days[_day] = _mask;
+    writeDays();
+    buildSchedule();
+  }
 }
 
-void SerialAlarm::tick(clkDateTime _time)
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::isHoliday(uint16_t _date)
 {
-  uint16_t tm = _time.hour() * 60 + _time.minute();
-  setLed(tm);
+  return ((_date < ALARM_DATE_COUNT) && !(holidays[_date >> 3] & (1 << (_date & 0x07))));
+}
 
-  if (state == ALARM_ON)
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+bool SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setHoliday(uint16_t _date, bool _on)
+{
+  if (_date >= ALARM_DATE_COUNT)
   {
-    if (tm * 60ul + _time.second() == next_point * 60ul)
+    return (false);
+  }
+
+  uint8_t &x = holidays[_date >> 3];
+  uint8_t y = (_on) ? x & ~(1 << (_date & 0x07)) : x | (1 << (_date & 0x07));
+  if (x != y)
+  {
+    x = y;
+    writeHolidays();
+  }
+  if (_date == date && holiday != _on)
+  {
+    holiday = _on;
+    buildSchedule();
+  }
+
+  return (true);
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::clearHolidays()
+{
+  memset(holidays, 0xFF, sizeof(holidays));
+  writeHolidays();
+  if (holiday)
+  {
+    holiday = false;
+    buildSchedule();
+  }
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::setDay(uint8_t _day, uint16_t _date)
+{
+  _day %= ALARM_DAY_COUNT;
+  if (day == _day && date == _date)
+  {
+    return;
+  }
+
+  day = _day;
+  date = _date;
+  holiday = isHoliday(_date);
+  // ближайшая точка ищется уже по плану нового дня
+  buildSchedule();
+}
+
+template <uint8_t RedPin, uint8_t GreenPin, uint16_t EepromIndex, typename Config>
+void SerialAlarm<RedPin, GreenPin, EepromIndex, Config>::tick(uint32_t _time)
+{
+  setLed(_time / 60);
+
+  // время, прошедшее с предыдущей проверки, и расстояние от нее до точки
+  // срабатывания, с учетом перехода через полночь
+  uint32_t span = (_time + 86400ul - last_time) % 86400ul;
+  uint32_t d = (next_point.point * 60ul + 86400ul - last_time) % 86400ul;
+  if (point_count && d != 0 && d <= span)
+  {
+    if (state == ALARM_ON)
     {
       state = ALARM_YES;
-      setNextPoint(next_point + read_eeprom_16(ALARM_INTERVAL));
-      if (!checkForInterval(next_point))
+      trigger_delay = span - d;
+      if (trigger_delay > max_trigger_delay)
+      {
+        max_trigger_delay = trigger_delay;
+      }
+    }
+    else if (state == ALARM_YES && missed_count < 0xFFFF)
+    { // предыдущий сигнал еще звучит
+      missed_count++;
+    }
+
+    if (state != ALARM_OFF)
+    { // точки, пройденные этой же проверкой вслед за первой
+      AlarmCursor x = next_point;
+      for (uint16_t i = 1; i < point_count && missed_count < 0xFFFF; i++)
       {
-        next_point = getAlarmPoint1();
+        nextPoint(x);
+        uint32_t dx = (x.point * 60ul + 86400ul - last_time) % 86400ul;
+        if (dx == 0 || dx > span)
+        {
+          break;
+        }
+        missed_count++;
       }
     }
+    // точка пройдена - даже если будильник в этот момент не был включен
+    next_point = seekPoint(_time + 1);
   }
+  last_time = _time;
 }
 
 // ===================================================
 
-SerialAlarm saAlarm(ALARM_RED_PIN, ALARM_GREEN_PIN, ALARM_EEPROM_INDEX);
+SerialAlarm<ALARM_RED_PIN, ALARM_GREEN_PIN, ALARM_EEPROM_INDEX> saAlarm;
@@ -0,0 +1,273 @@
+/**
+ * @file button_events.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Захват нажатий кнопок по прерываниям PCINT;
+ *
+ *        изменения состояния кнопок Set, Up и Down фиксируются в прерывании
+ *        со временем в микросекундах и складываются в кольцевой буфер без
+ *        блокировок (пишет только прерывание, читает только loop()); по
+ *        событиям из буфера задача опроса кнопок запускается только на время
+ *        работы с кнопками, а сработавший будильник отключается сразу по
+ *        нажатию, без ожидания распознавания клика библиотекой;
+ *
+ *        на платформах, отличных от AVR, прерывания не используются, и
+ *        работа с кнопками считается активной всегда;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include <shSimpleClock.h>
+#include "clockSetting.h"
+
+#define BUTTON_EVENTS_SIZE 8     // размер буфера событий, степень двойки
+#define BUTTON_EVENTS_BTN_COUNT 3 // количество отслеживаемых кнопок - Set, Up, Down
+// время после последнего изменения состояния кнопок, в течение которого
+// библиотека еще может выдать событие клика, мс
+#define BUTTON_EVENTS_ACTIVE_TIME (TIMEOUT_OF_DBLCLICK + TIMEOUT_OF_DEBOUNCE + 100)
+
+struct ButtonEvent // событие кнопки
+{
+  uint8_t button; // кнопка, clkButtonType
+  bool pressed;   // true - нажатие, false - отпускание
+  uint32_t time;  // время события, micros()
+};
+
+class ButtonEvents
+{
+private:
+  ButtonEvent buffer[BUTTON_EVENTS_SIZE];
+  volatile uint8_t head;  // индекс для записи следующего события, меняется только в прерывании
+  volatile uint8_t tail;  // индекс для чтения следующего события, меняется только в loop()
+  volatile uint8_t state; // битовая маска нажатых кнопок по последнему прерыванию
+  uint8_t overflow;       // количество событий, потерянных из-за переполнения буфера
+  uint32_t last_time[BUTTON_EVENTS_BTN_COUNT]; // время последнего принятого события каждой кнопки
+  uint32_t active_time;   // время последнего принятого события любой кнопки
+  uint32_t latency;       // задержка последнего действия от нажатия, мкс
+  uint32_t max_latency;   // максимальная задержка действия от нажатия, мкс
+#if defined(__AVR__)
+  volatile uint8_t *port[BUTTON_EVENTS_BTN_COUNT]; // регистры входов кнопок
+  uint8_t mask[BUTTON_EVENTS_BTN_COUNT];           // биты кнопок в регистрах входов
+#endif
+
+  uint8_t readState();
+
+public:
+  ButtonEvents();
+
+  /**
+   * @brief включение прерываний PCINT на пинах кнопок; вызывается в setup()
+   *        после инициализации кнопок библиотекой
+   */
+  void begin();
+
+  /**
+   * @brief обработка изменения состояния пинов; вызывается из прерывания
+   */
+  void onChange();
+
+  /**
+   * @brief проверка наличия необработанных событий
+   *
+   * @return true
+   * @return false
+   */
+  bool available();
+
+  /**
+   * @brief получение очередного события; события, пришедшие раньше
+   *        TIMEOUT_OF_DEBOUNCE после предыдущего события той же кнопки,
+   *        считаются дребезгом и пропускаются
+   *
+   * @param _event переменная для события
+   * @return true - событие получено
+   * @return false - событий больше нет
+   */
+  bool getEvent(ButtonEvent &_event);
+
+  /**
+   * @brief проверка, идет ли работа с кнопками - нажата хотя бы одна кнопка
+   *        или с последнего события прошло меньше BUTTON_EVENTS_ACTIVE_TIME
+   *
+   * @return true
+   * @return false
+   */
+  bool isActive();
+
+  /**
+   * @brief фиксация задержки действия от нажатия кнопки
+   *
+   * @param _press_time время нажатия, micros()
+   */
+  void setActionTime(uint32_t _press_time);
+
+  /**
+   * @brief получение задержки последнего действия от нажатия кнопки
+   *
+   * @return uint32_t задержка, мкс
+   */
+  uint32_t getLatency();
+
+  /**
+   * @brief получение максимальной задержки действия от нажатия кнопки
+   *
+   * @return uint32_t задержка, мкс
+   */
+  uint32_t getMaxLatency();
+
+  /**
+   * @brief получение количества событий, потерянных из-за переполнения
+   *        буфера
+   *
+   * @return uint8_t
+   */
+  uint8_t getOverflowCount();
+};
+
+// ---- private ---------------------------------
+
+uint8_t ButtonEvents::readState()
+{
+  uint8_t result = 0;
+#if defined(__AVR__)
+  // уровень нажатой кнопки зависит от подтяжки и типа кнопки
+  bool level = (BTN_INPUT_TYPE == PULL_UP) ^ (BTN_TYPE == BTN_NC) ? LOW : HIGH;
+  for (uint8_t i = 0; i < BUTTON_EVENTS_BTN_COUNT; i++)
+  {
+    if (port[i] && (bool)(*port[i] & mask[i]) == level)
+    {
+      result |= 1 << i;
+    }
+  }
+#endif
+
+  return (result);
+}
+
+// ---- public ----------------------------------
+
+ButtonEvents::ButtonEvents()
+{
+  head = 0;
+  tail = 0;
+  state = 0;
+  overflow = 0;
+  memset(last_time, 0, sizeof(last_time));
+  active_time = 0;
+  latency = 0;
+  max_latency = 0;
+}
+
+void ButtonEvents::begin()
+{
+#if defined(__AVR__)
+  int8_t pins[BUTTON_EVENTS_BTN_COUNT];
+  pins[CLK_BTN_SET] = BTN_SET_PIN;
+  pins[CLK_BTN_UP] = BTN_UP_PIN;
+  pins[CLK_BTN_DOWN] = BTN_DOWN_PIN;
+
+  for (uint8_t i = 0; i < BUTTON_EVENTS_BTN_COUNT; i++)
+  {
+    port[i] = NULL;
+    if (pins[i] < 0 || digitalPinToPCICR(pins[i]) == NULL)
+    { // кнопка не используется или на пине нет PCINT
+      continue;
+    }
+    port[i] = portInputRegister(digitalPinToPort(pins[i]));
+    mask[i] = digitalPinToBitMask(pins[i]);
+    *digitalPinToPCMSK(pins[i]) |= 1 << digitalPinToPCMSKbit(pins[i]);
+    *digitalPinToPCICR(pins[i]) |= 1 << digitalPinToPCICRbit(pins[i]);
+  }
+  state = readState();
+#endif
+}
+
+void ButtonEvents::onChange()
+{
+  uint8_t x = readState();
+  uint8_t changed = x ^ state;
+  state = x;
+
+  for (uint8_t i = 0; changed; i++, changed >>= 1)
+  {
+    if (!(changed & 0x01))
+    {
+      continue;
+    }
+    uint8_t next = (head + 1) & (BUTTON_EVENTS_SIZE - 1);
+    if (next == tail)
+    {
+      overflow++;
+      continue;
+    }
+    buffer[head].button = i;
+    buffer[head].pressed = x & (1 << i);
+    buffer[head].time = micros();
+    head = next;
+  }
+}
+
+bool ButtonEvents::available() { return (head != tail); }
+
+bool ButtonEvents::getEvent(ButtonEvent &_event)
+{
+  while (head != tail)
+  {
+    _event = buffer[tail];
+    tail = (tail + 1) & (BUTTON_EVENTS_SIZE - 1);
+
+    if (_event.time - last_time[_event.button] >= TIMEOUT_OF_DEBOUNCE * 1000ul)
+    {
+      last_time[_event.button] = _event.time;
+      active_time = _event.time;
+      return (true);
+    }
+  }
+
+  return (false);
+}
+
+bool ButtonEvents::isActive()
+{
+#if defined(__AVR__)
+  return (state || (micros() - active_time < BUTTON_EVENTS_ACTIVE_TIME * 1000ul));
+#else
+  return (true);
+#endif
+}
+
+void ButtonEvents::setActionTime(uint32_t _press_time)
+{
+  latency = micros() - _press_time;
+  if (latency > max_latency)
+  {
+    max_latency = latency;
+  }
+}
+
+uint32_t ButtonEvents::getLatency() { return (latency); }
+
+uint32_t ButtonEvents::getMaxLatency() { return (max_latency); }
+
+uint8_t ButtonEvents::getOverflowCount() { return (overflow); }
+
+// ===================================================
+
+ButtonEvents saButtons;
+
+#if defined(__AVR__)
+#if defined(PCINT0_vect)
+ISR(PCINT0_vect) { saButtons.onChange(); }
+#endif
+#if defined(PCINT1_vect)
+ISR(PCINT1_vect) { saButtons.onChange(); }
+#endif
+#if defined(PCINT2_vect)
+ISR(PCINT2_vect) { saButtons.onChange(); }
+#endif
+#endif
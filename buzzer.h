@@ -0,0 +1,302 @@
+/**
+ * @file buzzer.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Проигрыватель мелодий пищалки будильника;
+ *
+ *        мелодия проигрывается по прерыванию таймера 1 (раз в миллисекунду)
+ *        и не зависит от загрузки цикла loop() и задач shSimpleClock; сам
+ *        звук формирует tone() на таймере 2; прерывание таймера 1 включено
+ *        только во время проигрывания мелодии;
+ *
+ *        мелодия - это поток команд в PROGMEM:
+ *          BZ_TONE(f, d) - звук частотой f Гц длительностью d мс;
+ *          BZ_PAUSE(d)   - пауза длительностью d мс;
+ *          BZ_LOOP(n)    - начало блока, повторяемого n раз;
+ *          BZ_NEXT       - конец повторяемого блока (вложенность не
+ *                          поддерживается);
+ *          BZ_END        - конец мелодии, мелодия начинается сначала;
+ *        длительности задаются с шагом 10 мс, не больше 2550 мс;
+ *
+ *        мелодия повторяется, пока не истечет заданная общая длительность
+ *        сигнала или проигрывание не будет остановлено;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include "header_file.h"
+
+enum BuzzerOpcode : uint8_t // команды мелодии
+{
+  BZ_OP_END,   // конец мелодии
+  BZ_OP_TONE,  // звук, далее частота (uint16_t) и длительность (uint8_t, десятки мс)
+  BZ_OP_PAUSE, // пауза, далее длительность (uint8_t, десятки мс)
+  BZ_OP_LOOP,  // начало повторяемого блока, далее количество повторов (uint8_t)
+  BZ_OP_NEXT   // конец повторяемого блока
+};
+
+#define BZ_TONE(f, d) BZ_OP_TONE, (uint8_t)((f) & 0xFF), (uint8_t)((f) >> 8), (uint8_t)((d) / 10)
+#define BZ_PAUSE(d) BZ_OP_PAUSE, (uint8_t)((d) / 10)
+#define BZ_LOOP(n) BZ_OP_LOOP, (uint8_t)(n)
+#define BZ_NEXT BZ_OP_NEXT
+#define BZ_END BZ_OP_END
+
+// ==== мелодии ======================================
+
+// четыре коротких сигнала в секунду
+static const uint8_t PROGMEM buzzer_melody_0[] = {
+    BZ_LOOP(3), BZ_TONE(2000, 70), BZ_PAUSE(70), BZ_NEXT,
+    BZ_TONE(2000, 70), BZ_PAUSE(510),
+    BZ_END};
+
+// "звонок" - длинный сигнал раз в секунду
+static const uint8_t PROGMEM buzzer_melody_1[] = {
+    BZ_TONE(1500, 500), BZ_PAUSE(500),
+    BZ_END};
+
+// "сирена" - чередование двух тонов
+static const uint8_t PROGMEM buzzer_melody_2[] = {
+    BZ_TONE(1800, 250), BZ_TONE(1200, 250),
+    BZ_END};
+
+static const uint8_t *const PROGMEM buzzer_melodies[] = {
+    buzzer_melody_0,
+    buzzer_melody_1,
+    buzzer_melody_2};
+
+#define BUZZER_MELODY_COUNT (sizeof(buzzer_melodies) / sizeof(buzzer_melodies[0]))
+
+// ===================================================
+
+class AlarmBuzzer
+{
+private:
+  const uint8_t *melody; // начало мелодии в PROGMEM
+  uint16_t pos;          // смещение следующей команды от начала мелодии
+  uint16_t loop_pos;     // смещение начала повторяемого блока
+  uint8_t loop_count;    // оставшееся количество повторов блока
+  uint16_t note_left;    // оставшаяся длительность текущего звука или паузы, мс
+  uint32_t total_left;   // оставшаяся общая длительность сигнала, мс
+  volatile bool running; // флаг проигрывания мелодии, сбрасывается в прерывании
+#if !defined(__AVR__)
+  uint32_t last_millis; // время последнего шага при проигрывании без таймера
+#endif
+
+  void next();
+
+  void finish();
+
+  void startTimer();
+
+  void stopTimer();
+
+public:
+  AlarmBuzzer();
+
+  /**
+   * @brief начало проигрывания мелодии
+   *
+   * @param _melody номер мелодии, 0..BUZZER_MELODY_COUNT - 1
+   * @param _duration общая длительность сигнала, секунд
+   */
+  void start(uint8_t _melody, uint16_t _duration);
+
+  /**
+   * @brief остановка проигрывания мелодии
+   */
+  void stop();
+
+  /**
+   * @brief проверка, проигрывается ли мелодия; после истечения общей
+   *        длительности сигнала возвращает false
+   *
+   * @return true
+   * @return false
+   */
+  bool isRunning();
+
+  /**
+   * @brief шаг проигрывания мелодии на одну миллисекунду; вызывается из
+   *        прерывания таймера
+   */
+  void onTimer();
+
+  /**
+   * @brief на AVR ничего не делает; на других платформах, где прерывание
+   *        таймера не используется, выполняет шаги проигрывания по millis();
+   *        вызывается из loop()
+   */
+  void tick();
+};
+
+// ---- private ---------------------------------
+
+void AlarmBuzzer::next()
+{
+  // команды выбираются до первого звука или паузы ненулевой длительности;
+  // ограничение числа команд защищает от зацикливания на мелодии без звуков
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    uint8_t op = pgm_read_byte(melody + pos++);
+    switch (op)
+    {
+    case BZ_OP_TONE:
+    {
+      uint16_t f = pgm_read_byte(melody + pos) | (pgm_read_byte(melody + pos + 1) << 8);
+      note_left = pgm_read_byte(melody + pos + 2) * 10;
+      pos += 3;
+      if (note_left)
+      {
+        tone(ALARM_BUZZER_PIN, f);
+        return;
+      }
+      break;
+    }
+    case BZ_OP_PAUSE:
+      note_left = pgm_read_byte(melody + pos++) * 10;
+      if (note_left)
+      {
+        noTone(ALARM_BUZZER_PIN);
+        return;
+      }
+      break;
+    case BZ_OP_LOOP:
+      loop_count = pgm_read_byte(melody + pos++);
+      loop_pos = pos;
+      break;
+    case BZ_OP_NEXT:
+      if (loop_count > 1)
+      {
+        loop_count--;
+        pos = loop_pos;
+      }
+      break;
+    default:
+      pos = 0;
+      break;
+    }
+  }
+
+  finish();
+}
+
+void AlarmBuzzer::finish()
+{
+  stopTimer();
+  noTone(ALARM_BUZZER_PIN);
+  running = false;
+}
+
+void AlarmBuzzer::startTimer()
+{
+#if defined(__AVR__)
+  // таймер 1 в режиме CTC, делитель 64, прерывание раз в миллисекунду
+  TCCR1A = 0;
+  TCCR1B = (1 << WGM12) | (1 << CS11) | (1 << CS10);
+  OCR1A = F_CPU / 64 / 1000 - 1;
+  TCNT1 = 0;
+  TIFR1 = (1 << OCF1A);
+  TIMSK1 |= (1 << OCIE1A);
+#else
+  last_millis = millis();
+#endif
+}
+
+void AlarmBuzzer::stopTimer()
+{
+#if defined(__AVR__)
+  TIMSK1 &= ~(1 << OCIE1A);
+  TCCR1B = 0;
+#endif
+}
+
+// ---- public ----------------------------------
+
+AlarmBuzzer::AlarmBuzzer()
+{
+  melody = buzzer_melody_0;
+  pos = 0;
+  loop_pos = 0;
+  loop_count = 0;
+  note_left = 0;
+  total_left = 0;
+  running = false;
+}
+
+void AlarmBuzzer::start(uint8_t _melody, uint16_t _duration)
+{
+  stop();
+
+  if (_duration == 0)
+  {
+    return;
+  }
+  if (_melody >= BUZZER_MELODY_COUNT)
+  {
+    _melody = 0;
+  }
+  melody = (const uint8_t *)pgm_read_ptr(&buzzer_melodies[_melody]);
+  pos = 0;
+  loop_count = 0;
+  total_left = _duration * 1000ul;
+  running = true;
+  // прерывание таймера еще выключено, поэтому первый звук запускается здесь
+  next();
+  if (running)
+  {
+    startTimer();
+  }
+}
+
+void AlarmBuzzer::stop()
+{
+  // мелодия может закончиться в прерывании в этот же момент
+  noInterrupts();
+  if (running)
+  {
+    finish();
+  }
+  interrupts();
+}
+
+bool AlarmBuzzer::isRunning() { return (running); }
+
+void AlarmBuzzer::onTimer()
+{
+  if (--total_left == 0)
+  {
+    finish();
+    return;
+  }
+  if (--note_left == 0)
+  {
+    next();
+  }
+}
+
+void AlarmBuzzer::tick()
+{
+#if !defined(__AVR__)
+  while (running && (millis() - last_millis))
+  {
+    last_millis++;
+    onTimer();
+  }
+#endif
+}
+
+// ===================================================
+
+AlarmBuzzer saBuzzer;
+
+#if defined(__AVR__)
+ISR(TIMER1_COMPA_vect)
+{
+  saBuzzer.onTimer();
+}
+#endif
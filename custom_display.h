@@ -15,6 +15,7 @@
 #include <Arduino.h>
 #include <shSimpleClock.h>
 #include "header_file.h"
+#include "screen_sequence.h"
 
 // ===================================================
 
@@ -24,19 +25,25 @@ void getData(uint8_t &h, uint8_t &m)
   {
   case ALARM_DATA_HOUR_1:
   case ALARM_DATA_MINUTE_1:
-    h = saAlarm.getAlarmPoint1() / 60u;
-    m = saAlarm.getAlarmPoint1() % 60u;
+    h = saAlarm.getAlarmPoint1(saAlarmWindow) / 60u;
+    m = saAlarm.getAlarmPoint1(saAlarmWindow) % 60u;
     break;
   case ALARM_DATA_HOUR_2:
   case ALARM_DATA_MINUTE_2:
-    h = saAlarm.getAlarmPoint2() / 60u;
-    m = saAlarm.getAlarmPoint2() % 60u;
+    h = saAlarm.getAlarmPoint2(saAlarmWindow) / 60u;
+    m = saAlarm.getAlarmPoint2(saAlarmWindow) % 60u;
     break;
   case ALARM_DATA_ON_OFF:
     h = (uint8_t)saAlarm.getOnOffAlarm();
     break;
+  case ALARM_DATA_WINDOW:
+    h = saAlarmWindow;
+    break;
+  case ALARM_DATA_WINDOW_ON_OFF:
+    h = (uint8_t)saAlarm.getOnOffWindow(saAlarmWindow);
+    break;
   case ALARM_DATA_INTERVAL:
-    h = saAlarm.getAlarmInterval();
+    h = saAlarm.getAlarmInterval(saAlarmWindow);
     break;
   default:
     break;
@@ -49,23 +56,30 @@ void saveData(uint8_t h, uint8_t m)
   {
   case ALARM_DATA_HOUR_1:
   case ALARM_DATA_MINUTE_1:
-    saAlarm.setAlarmPoint1(h * 60 + m);
+    saAlarm.setAlarmPoint1(h * 60 + m, saAlarmWindow);
     break;
   case ALARM_DATA_HOUR_2:
   case ALARM_DATA_MINUTE_2:
-    saAlarm.setAlarmPoint2(h * 60 + m);
+    saAlarm.setAlarmPoint2(h * 60 + m, saAlarmWindow);
     break;
   case ALARM_DATA_ON_OFF:
     saAlarm.setOnOffAlarm((bool)h);
     break;
+  case ALARM_DATA_WINDOW:
+    saAlarmWindow = h;
+    break;
+  case ALARM_DATA_WINDOW_ON_OFF:
+    saAlarm.setOnOffWindow(saAlarmWindow, (bool)h);
+    break;
   case ALARM_DATA_INTERVAL:
-    saAlarm.setAlarmInterval(h);
+    saAlarm.setAlarmInterval(h, saAlarmWindow);
     break;
   default:
     break;
   }
 
-  saAlarm.init(saClock.getCurrentDateTime());
+  saAlarm.init(saTime.getTime());
+  checkAlarm();
 }
 
 void checkSettingData(uint8_t &h, uint8_t &m, bool dir)
@@ -81,8 +95,12 @@ void checkSettingData(uint8_t &h, uint8_t &m, bool dir)
     checkData(m, 59, dir);
     break;
   case ALARM_DATA_ON_OFF:
+  case ALARM_DATA_WINDOW_ON_OFF:
     checkData(h, 1, true);
     break;
+  case ALARM_DATA_WINDOW:
+    checkData(h, ALARM_WINDOW_COUNT - 1, dir);
+    break;
   case ALARM_DATA_INTERVAL:
     checkData(h, MIN_INTERVAL, MAX_INTERVAL, INTERVAL_INC_STEP, dir);
     break;
@@ -134,12 +152,15 @@ void showAlarmSettingInterface()
       n = 0;
       if (saAlarmDataType == ALARM_DATA_INTERVAL ||
           (saAlarmDataType == ALARM_DATA_ON_OFF && saAlarm.getAlarmState() == ALARM_OFF) ||
-          (saAlarmDataType == ALARM_DATA_MINUTE_2 && saAlarm.getAlarmPoint1() == saAlarm.getAlarmPoint2()))
+          (saAlarmDataType == ALARM_DATA_ON_OFF && saAlarm.getAlarmMode() == ALARM_MODE_LIST) ||
+          (saAlarmDataType == ALARM_DATA_WINDOW_ON_OFF && !saAlarm.getOnOffWindow(saAlarmWindow)) ||
+          (saAlarmDataType == ALARM_DATA_MINUTE_2 && saAlarm.getAlarmPoint1(saAlarmWindow) == saAlarm.getAlarmPoint2(saAlarmWindow)))
       {
         // выход из режима настройки по клику кнопкой Set в случае, если:
         // 1. мы находимся в режиме настройки интервала (он последний);
-        // 2. если будильник выключен;
-        // 3. если время начала и окончания сигнализации одинаково (однократное срабатывание);
+        // 2. если будильник выключен или работает по списку точек;
+        // 3. если выбранный промежуток выключен;
+        // 4. если время начала и окончания сигнализации одинаково (однократное срабатывание);
         saClock.setButtonFlag(CLK_BTN_SET, CLK_BTN_FLAG_EXIT);
       }
       else
@@ -179,6 +200,12 @@ void showAlarmSettingInterface()
   case ALARM_DATA_ON_OFF:
     showAlarmState(curHour);
     break;
+  case ALARM_DATA_WINDOW:
+    showWindowState(curHour, saAlarm.getOnOffWindow(curHour));
+    break;
+  case ALARM_DATA_WINDOW_ON_OFF:
+    showWindowState(saAlarmWindow, curHour);
+    break;
   case ALARM_DATA_INTERVAL:
     showTimeData(curHour / 60, curHour % 60);
     break;
@@ -231,80 +258,44 @@ void showTimeData(uint8_t hour, uint8_t minute)
   clkDisplay.setDispData(3, n3);
 }
 
-void showAlarmSetting()
+void showNumber(uint16_t _num)
 {
-  static uint8_t n = 0;
-  static uint8_t k = 0;
-  static uint16_t y = 0;
-  // количество циклов вывода информации - если время начала и окончания
-  // сигнализации одинаковое - выводится только одно время, иначе выводятся обе
-  // точки, интервал и время следующего срабатывания
-  uint8_t rep = (saAlarm.getAlarmPoint1() == saAlarm.getAlarmPoint2()) ? 1 : 4;
+  // число выводится без ведущих нулей, значения больше 9999 - как 9999
+  if (_num > 9999)
+  {
+    _num = 9999;
+  }
+  for (int8_t i = 3; i >= 0; i--)
+  {
+    clkDisplay.setDispData(i, (_num || i == 3) ? clkDisplay.encodeDigit(_num % 10) : 0x00);
+    _num /= 10;
+  }
+}
 
-  if (!saClock.getTaskState(show_alarm_setting_mode))
+void showAlarmSetting()
+{
+  // экраны описаны таблицей в screen_sequence.h
+  if (!saScreens.isRunning())
   {
-    saClock.startTask(show_alarm_setting_mode);
-    n = 0;
-    k = 0;
     if (saAlarmDataType == ALARM_DATA_PONT_LIST)
     {
-      y = saAlarm.getAlarmPoint1();
+      saScreens.start(SCREEN_SEQ_POINT_LIST);
     }
-  }
-
-  if (saAlarmDataType == ALARM_DATA_NO)
-  {
-    uint16_t x = 0;
-    saAlarmSettingDataType m = ALARM_DATA_HOUR_1;
-    switch (k)
+    else if (saAlarmDataType == ALARM_DATA_TRIGGER_STATS)
     {
-    case 0:
-      m = ALARM_DATA_HOUR_1;
-      x = saAlarm.getAlarmPoint1();
-      break;
-    case 1:
-      m = ALARM_DATA_HOUR_2;
-      x = saAlarm.getAlarmPoint2();
-      break;
-    case 2:
-      m = ALARM_DATA_INTERVAL;
-      x = saAlarm.getAlarmInterval();
-      break;
-    case 3:
-      m = ALARM_DATA_NEXT_POINT;
-      x = saAlarm.getNextPoint();
-      break;
+      saScreens.start(SCREEN_SEQ_TRIGGER_STATS);
     }
-
-    (n < 8) ? showSettingType(m) : showTimeData(x / 60, x % 60);
-
-    if (++n > 19)
+    else
     {
-      n = 0;
-      if (++k >= rep)
-      {
-        saClock.stopTask(show_alarm_setting_mode);
-        saClock.setDisplayMode(DISPLAY_MODE_SHOW_TIME);
-      }
+      saScreens.start((saAlarm.getAlarmMode() == ALARM_MODE_LIST) ? SCREEN_SEQ_NEXT_POINT
+                                                                  : SCREEN_SEQ_INFO);
     }
   }
-  else
-  {
-    (n < 4 || n > 15) ? showSettingType(ALARM_DATA_PONT_LIST) : showTimeData(y / 60, y % 60);
-
-    if (++n > 19)
-    {
-      n = 0;
-      k++;
 
-      y += saAlarm.getAlarmInterval();
-      if (!saAlarm.checkForInterval(y))
-      {
-        saClock.stopTask(show_alarm_setting_mode);
-        saAlarmDataType = ALARM_DATA_NO;
-        saClock.setDisplayMode(DISPLAY_MODE_SHOW_TIME);
-      }
-    }
+  if (!saScreens.tick())
+  {
+    saAlarmDataType = ALARM_DATA_NO;
+    saClock.setDisplayMode(DISPLAY_MODE_SHOW_TIME);
   }
 }
 
@@ -325,12 +316,28 @@ void showAlarmState(uint8_t _state)
   }
 }
 
+void showWindowState(uint8_t _window, uint8_t _state)
+{
+  uint8_t n1 = clkDisplay.encodeDigit(_window + 1);
+  uint8_t n3 = (_state) ? 0b01011100 : 0b00001000;
+  // мигает настраиваемый параметр - номер промежутка или его состояние
+  if (!saClock.getBlink() &&
+      !saClock.isButtonClosed(CLK_BTN_UP) &&
+      !saClock.isButtonClosed(CLK_BTN_DOWN))
+  {
+    (saAlarmDataType == ALARM_DATA_WINDOW) ? n1 = 0 : n3 = 0;
+  }
+  clkDisplay.setDispData(0, 0b01010100); // "n"
+  clkDisplay.setDispData(1, n1 + 0x80);  // номер промежутка с двоеточием
+  clkDisplay.setDispData(2, 0x00);
+  clkDisplay.setDispData(3, n3);
+}
+
 void showSettingType(saAlarmSettingDataType _type)
 {
   // ALARM_DATA_HOUR_1     - P1:
   // ALARM_DATA_HOUR_2     - P2:
   // ALARM_DATA_INTERVAL   - It:
-  // ALARM_DATA_NEXT_POINT - Pn:
   switch (_type)
   {
   case ALARM_DATA_HOUR_1:
@@ -345,14 +352,6 @@ void showSettingType(saAlarmSettingDataType _type)
     clkDisplay.setDispData(0, 0b00000110);
     clkDisplay.setDispData(1, 0b11111000);
     break;
-  case ALARM_DATA_NEXT_POINT:
-    clkDisplay.setDispData(0, 0b01110011);
-    clkDisplay.setDispData(1, 0b11010100);
-    break;
-  case ALARM_DATA_PONT_LIST:
-    clkDisplay.setDispData(0, 0x00);
-    clkDisplay.setDispData(1, 0x00);
-    break;
   default:
     break;
   }
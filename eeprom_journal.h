@@ -0,0 +1,206 @@
+/**
+ * @file eeprom_journal.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Журнал записей настроек в EEPROM с выравниванием износа;
+ *
+ *        блок данных сохраняется не по фиксированному адресу, а каждый раз в
+ *        следующий по кругу слот отведенной области EEPROM, поэтому каждая
+ *        ячейка перезаписывается во столько раз реже, сколько слотов; запись
+ *        содержит версию формата, порядковый номер и контрольную сумму
+ *        CRC16, поэтому недописанная (например, при пропадании питания)
+ *        или испорченная запись обнаруживается и пропускается, а при
+ *        загрузке используется предыдущая целая запись;
+ *
+ *        структура слота: версия (uint8_t), номер записи (uint8_t), данные,
+ *        CRC16 версии, номера и данных (uint16_t);
+ *
+ *        при загрузке просматриваются только заголовки слотов, а данные
+ *        считываются одним блоком только из самого нового слота; проверка
+ *        CRC идет одновременно с чтением;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "eeprom_queue.h"
+
+#define EEPROM_JOURNAL_HEADER_SIZE 2 // размер заголовка слота - версия и номер записи, байт
+#define EEPROM_JOURNAL_CRC_SIZE 2    // размер контрольной суммы слота, байт
+
+class EepromJournal
+{
+private:
+  uint16_t eeprom_index; // индекс первого слота в EEPROM
+  uint8_t slot_count;    // количество слотов
+  uint8_t data_size;     // размер блока данных, байт
+  uint8_t version;       // версия формата данных
+  uint8_t slot;          // слот последней действующей записи
+  uint8_t seq;           // номер последней действующей записи
+
+  uint16_t getSlotIndex(uint8_t _slot);
+
+  uint16_t crc16(uint16_t _crc, uint8_t _data);
+
+  bool readSlot(uint8_t _slot, void *_data);
+
+public:
+  /**
+   * @brief конструктор журнала
+   *
+   * @param _eeprom_index индекс первого слота в EEPROM
+   * @param _slot_count количество слотов, не больше 32
+   * @param _data_size размер блока данных, байт
+   * @param _version версия формата данных; записи другой версии считаются
+   *        недействительными
+   */
+  EepromJournal(uint16_t _eeprom_index, uint8_t _slot_count, uint8_t _data_size, uint8_t _version);
+
+  /**
+   * @brief поиск последней действующей записи за один проход по заголовкам
+   *        слотов и чтение ее данных одним блоком; если данные не проходят
+   *        проверку CRC, берется предыдущая запись
+   *
+   * @param _data буфер для данных размером не меньше data_size
+   * @return true - запись найдена и считана
+   * @return false - действующих записей нет, содержимое буфера не определено
+   */
+  bool load(void *_data);
+
+  /**
+   * @brief получение размера записи журнала - места, которое она займет в
+   *        EEPROM и в очереди отложенной записи
+   *
+   * @return uint8_t размер, байт
+   */
+  uint8_t getRecordSize();
+
+  /**
+   * @brief сохранение данных в следующий по кругу слот; запись ставится в
+   *        очередь отложенной записи в EEPROM
+   *
+   * @param _data сохраняемые данные размером data_size
+   */
+  void save(const void *_data);
+};
+
+// ---- private ---------------------------------
+
+uint16_t EepromJournal::getSlotIndex(uint8_t _slot)
+{
+  return (eeprom_index + _slot * getRecordSize());
+}
+
+uint16_t EepromJournal::crc16(uint16_t _crc, uint8_t _data)
+{
+  // CRC-16/CCITT, полином 0x1021
+  _crc ^= (uint16_t)_data << 8;
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    _crc = (_crc & 0x8000) ? (_crc << 1) ^ 0x1021 : _crc << 1;
+  }
+
+  return (_crc);
+}
+
+bool EepromJournal::readSlot(uint8_t _slot, void *_data)
+{
+  uint16_t index = getSlotIndex(_slot);
+  uint16_t crc = crc16(crc16(0xFFFF, version), saEepromQueue.read(index + 1));
+  index += EEPROM_JOURNAL_HEADER_SIZE;
+
+  uint8_t *p = (uint8_t *)_data;
+  for (uint8_t i = 0; i < data_size; i++)
+  {
+    p[i] = saEepromQueue.read(index++);
+    crc = crc16(crc, p[i]);
+  }
+  uint16_t x;
+  saEepromQueue.get(index, x);
+
+  return (x == crc);
+}
+
+// ---- public ----------------------------------
+
+EepromJournal::EepromJournal(uint16_t _eeprom_index, uint8_t _slot_count, uint8_t _data_size, uint8_t _version)
+{
+  eeprom_index = _eeprom_index;
+  slot_count = _slot_count;
+  data_size = _data_size;
+  version = _version;
+  slot = _slot_count - 1;
+  seq = 0xFF;
+}
+
+bool EepromJournal::load(void *_data)
+{
+  // заголовки считываются один раз, слоты другой версии сразу исключаются
+  uint8_t num[32];
+  uint32_t mask = 0;
+  for (uint8_t i = 0; i < slot_count; i++)
+  {
+    uint16_t index = getSlotIndex(i);
+    if (saEepromQueue.read(index) == version)
+    {
+      num[i] = saEepromQueue.read(index + 1);
+      mask |= 1ul << i;
+    }
+  }
+
+  while (mask)
+  {
+    // номера записей идут подряд по кругу, и все действующие записи
+    // отличаются меньше чем на slot_count, поэтому более новую запись
+    // определяет знак разности номеров
+    int8_t k = -1;
+    for (uint8_t i = 0; i < slot_count; i++)
+    {
+      if ((mask & (1ul << i)) && (k < 0 || (int8_t)(num[i] - num[k]) > 0))
+      {
+        k = i;
+      }
+    }
+
+    if (readSlot(k, _data))
+    {
+      slot = k;
+      seq = num[k];
+      return (true);
+    }
+    // испорченная запись исключается, и берется следующая по новизне
+    mask &= ~(1ul << k);
+  }
+
+  return (false);
+}
+
+uint8_t EepromJournal::getRecordSize() { return (EEPROM_JOURNAL_HEADER_SIZE + data_size + EEPROM_JOURNAL_CRC_SIZE); }
+
+void EepromJournal::save(const void *_data)
+{
+  if (++slot >= slot_count)
+  {
+    slot = 0;
+  }
+  seq++;
+
+  // данные пишутся в порядке следования, CRC - последней, поэтому запись,
+  // прерванная на любом байте, не пройдет проверку
+  uint16_t index = getSlotIndex(slot);
+  uint16_t crc = 0xFFFF;
+  const uint8_t *p = (const uint8_t *)_data;
+  for (uint8_t i = 0; i < EEPROM_JOURNAL_HEADER_SIZE + data_size; i++)
+  {
+    uint8_t x = (i == 0) ? version : (i == 1) ? seq
+                                              : p[i - EEPROM_JOURNAL_HEADER_SIZE];
+    crc = crc16(crc, x);
+    saEepromQueue.write(index++, x);
+  }
+  saEepromQueue.put(index, crc);
+}
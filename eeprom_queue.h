@@ -0,0 +1,266 @@
+/**
+ * @file eeprom_queue.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Очередь отложенной записи в EEPROM;
+ *
+ *        запись байта в EEPROM занимает около 3.3 мс, поэтому данные не
+ *        пишутся сразу, а ставятся в очередь, которая выбирается по одному
+ *        байту из loop() только тогда, когда EEPROM готова к записи, т.е.
+ *        без ожидания завершения предыдущей записи; чтение через очередь
+ *        возвращает еще не записанные данные;
+ *
+ *        данные хранятся в очереди блоками - индекс первой ячейки, длина и
+ *        байты подряд идущих ячеек, поэтому блок настроек занимает в памяти
+ *        лишь на EEPROM_QUEUE_BLOCK_HEADER байт больше своего размера;
+ *        прежде чем ставить блок в очередь, нужно проверить hasRoom() -
+ *        при переполнении очереди write() записывает ее начало с ожиданием
+ *        готовности EEPROM;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#define EEPROM_QUEUE_SIZE 72        // размер очереди, байт, включая заголовки блоков
+#define EEPROM_QUEUE_BLOCK_HEADER 3 // размер заголовка блока - индекс первой ячейки (uint16_t) и длина (uint8_t), байт
+
+class EepromQueue
+{
+private:
+  uint8_t queue[EEPROM_QUEUE_SIZE]; // блоки данных, первый записывается первым
+  uint8_t size;                     // занято байт
+  uint8_t last;                     // смещение последнего блока
+
+  uint16_t getBlockIndex(uint8_t _pos);
+
+  uint8_t find(uint16_t _index);
+
+  bool isReady();
+
+  void writeNext();
+
+public:
+  EepromQueue();
+
+  /**
+   * @brief постановка байта в очередь на запись; если в очереди уже есть
+   *        запись в эту же ячейку, она заменяется новым значением, байт для
+   *        ячейки, следующей за последним блоком, дописывается в этот блок;
+   *        при заполненной очереди ее начало записывается сразу
+   *
+   * @param _index индекс ячейки EEPROM
+   * @param _data записываемое значение
+   */
+  void write(uint16_t _index, uint8_t _data);
+
+  /**
+   * @brief постановка в очередь на запись произвольных данных
+   *
+   * @param _index индекс первой ячейки EEPROM
+   * @param _data записываемые данные
+   */
+  template <typename T>
+  void put(uint16_t _index, const T &_data);
+
+  /**
+   * @brief чтение байта с учетом еще не записанных данных
+   *
+   * @param _index индекс ячейки EEPROM
+   * @return uint8_t
+   */
+  uint8_t read(uint16_t _index);
+
+  /**
+   * @brief чтение произвольных данных с учетом еще не записанных данных
+   *
+   * @param _index индекс первой ячейки EEPROM
+   * @param _data переменная для считанных данных
+   * @return T&
+   */
+  template <typename T>
+  T &get(uint16_t _index, T &_data);
+
+  /**
+   * @brief проверка, поместится ли в очередь блок данных без записи ее
+   *        начала с ожиданием
+   *
+   * @param _size размер блока, байт
+   * @return true
+   * @return false
+   */
+  bool hasRoom(uint8_t _size);
+
+  /**
+   * @brief проверка очереди на отсутствие данных для записи
+   *
+   * @return true
+   * @return false
+   */
+  bool isEmpty();
+
+  /**
+   * @brief запись очередного байта, если EEPROM готова к записи; вызывается
+   *        из loop()
+   */
+  void tick();
+
+  /**
+   * @brief запись всей очереди с ожиданием готовности EEPROM
+   */
+  void flush();
+};
+
+// ---- private ---------------------------------
+
+uint16_t EepromQueue::getBlockIndex(uint8_t _pos)
+{
+  return (queue[_pos] | (queue[_pos + 1] << 8));
+}
+
+uint8_t EepromQueue::find(uint16_t _index)
+{
+  uint8_t pos = 0;
+  while (pos < size)
+  {
+    uint16_t x = _index - getBlockIndex(pos);
+    if (x < queue[pos + 2])
+    {
+      return (pos + EEPROM_QUEUE_BLOCK_HEADER + x);
+    }
+    pos += EEPROM_QUEUE_BLOCK_HEADER + queue[pos + 2];
+  }
+
+  return (EEPROM_QUEUE_SIZE);
+}
+
+bool EepromQueue::isReady()
+{
+#if defined(__AVR__)
+  return (eeprom_is_ready());
+#else
+  return (true);
+#endif
+}
+
+void EepromQueue::writeNext()
+{
+  // update() пишет ячейку, только если значение отличается
+  uint16_t index = getBlockIndex(0);
+  EEPROM.update(index, queue[EEPROM_QUEUE_BLOCK_HEADER]);
+
+  // записанный байт удаляется из начала первого блока, а весь блок - когда
+  // в нем не осталось данных
+  uint8_t n = (queue[2] > 1) ? 1 : EEPROM_QUEUE_BLOCK_HEADER + 1;
+  memmove(&queue[EEPROM_QUEUE_BLOCK_HEADER + 1 - n], &queue[EEPROM_QUEUE_BLOCK_HEADER + 1],
+          size - EEPROM_QUEUE_BLOCK_HEADER - 1);
+  size -= n;
+  last = (last) ? last - n : 0;
+  if (n == 1)
+  {
+    index++;
+    queue[0] = index & 0xFF;
+    queue[1] = index >> 8;
+    queue[2]--;
+  }
+}
+
+// ---- public ----------------------------------
+
+EepromQueue::EepromQueue()
+{
+  size = 0;
+  last = 0;
+}
+
+void EepromQueue::write(uint16_t _index, uint8_t _data)
+{
+  uint8_t x = find(_index);
+  if (x < EEPROM_QUEUE_SIZE)
+  {
+    queue[x] = _data;
+    return;
+  }
+
+  // байт для ячейки, следующей за последним блоком, дописывается в этот блок
+  bool append = size && queue[last + 2] < 0xFF && _index == getBlockIndex(last) + queue[last + 2];
+  while (size + ((append) ? 1 : EEPROM_QUEUE_BLOCK_HEADER + 1) > EEPROM_QUEUE_SIZE)
+  {
+    writeNext();
+    append = append && size;
+  }
+
+  if (append)
+  {
+    queue[last + 2]++;
+  }
+  else
+  {
+    last = size;
+    queue[size++] = _index & 0xFF;
+    queue[size++] = _index >> 8;
+    queue[size++] = 1;
+  }
+  queue[size++] = _data;
+}
+
+template <typename T>
+void EepromQueue::put(uint16_t _index, const T &_data)
+{
+  const uint8_t *p = (const uint8_t *)&_data;
+  for (uint8_t i = 0; i < sizeof(T); i++)
+  {
+    write(_index + i, p[i]);
+  }
+}
+
+uint8_t EepromQueue::read(uint16_t _index)
+{
+  uint8_t x = find(_index);
+
+  return ((x < EEPROM_QUEUE_SIZE) ? queue[x] : EEPROM.read(_index));
+}
+
+template <typename T>
+T &EepromQueue::get(uint16_t _index, T &_data)
+{
+  uint8_t *p = (uint8_t *)&_data;
+  for (uint8_t i = 0; i < sizeof(T); i++)
+  {
+    p[i] = read(_index + i);
+  }
+
+  return (_data);
+}
+
+bool EepromQueue::hasRoom(uint8_t _size)
+{
+  return (size + EEPROM_QUEUE_BLOCK_HEADER + _size <= EEPROM_QUEUE_SIZE);
+}
+
+bool EepromQueue::isEmpty() { return (size == 0); }
+
+void EepromQueue::tick()
+{
+  if (size && isReady())
+  {
+    writeNext();
+  }
+}
+
+void EepromQueue::flush()
+{
+  while (size)
+  {
+    writeNext();
+  }
+}
+
+// ===================================================
+
+EepromQueue saEepromQueue;
@@ -0,0 +1,68 @@
+/**
+ * @file fast_pin.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Вывод на пин, номер которого известен при компиляции;
+ *
+ *        для ATmega168/328 с раскладкой пинов Arduino Uno/Nano/Pro Mini
+ *        порт и бит пина вычисляются при компиляции, и запись на пин
+ *        сводится к одной инструкции sbi/cbi вместо поиска порта и бита в
+ *        таблицах digitalWrite(); на остальных контроллерах используется
+ *        digitalWrite();
+ *
+ *        в отличие от digitalWrite(), ШИМ на пине не отключается, поэтому
+ *        для пинов, на которые выводится analogWrite(), FastPin не подходит;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+
+#if defined(__AVR_ATmega168__) || defined(__AVR_ATmega168P__) || \
+    defined(__AVR_ATmega328__) || defined(__AVR_ATmega328P__)
+#define FAST_PIN_UNO_LAYOUT
+#endif
+
+template <uint8_t Pin>
+class FastPin
+{
+public:
+  /**
+   * @brief перевод пина в режим выхода
+   */
+  static void setOutput() { pinMode(Pin, OUTPUT); }
+
+  /**
+   * @brief запись уровня на пин
+   *
+   * @param _state уровень, HIGH или LOW
+   */
+  static void write(uint8_t _state)
+  {
+#ifdef FAST_PIN_UNO_LAYOUT
+    // пины 0..7 - порт D, 8..13 - порт B, 14..19 (A0..A5) - порт C
+    if (Pin < 8)
+    {
+      (_state) ? PORTD |= (1 << Pin) : PORTD &= ~(1 << Pin);
+    }
+    else if (Pin < 14)
+    {
+      (_state) ? PORTB |= (1 << (Pin - 8)) : PORTB &= ~(1 << (Pin - 8));
+    }
+    else if (Pin < 20)
+    {
+      (_state) ? PORTC |= (1 << (Pin - 14)) : PORTC &= ~(1 << (Pin - 14));
+    }
+    else
+    {
+      digitalWrite(Pin, _state);
+    }
+#else
+    digitalWrite(Pin, _state);
+#endif
+  }
+};
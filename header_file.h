@@ -1,14 +1,39 @@
 #pragma once
 #include <Arduino.h>
-#include "header_file.h"
+#include "clockSetting.h"
+#include <shSimpleClock.h>
 
 // ==== пины =========================================
 constexpr uint8_t ALARM_BUZZER_PIN = 7; // пин для подключения пищалки
 constexpr uint8_t ALARM_RED_PIN = 2;    // пин для подключения красного светодиода - индикатора будильника
 constexpr uint8_t ALARM_GREEN_PIN = 3;  // пин для подключения зеленого светодиода - индикатора будильника
+constexpr int8_t RTC_INT_PIN = 11;      // пин для подключения выхода INT/SQW модуля DS3231 (энергосберегающий режим)
+constexpr int8_t POWER_SENSE_PIN = -1;  // пин контроля внешнего питания, HIGH - питание есть, сон запрещен; -1 - не используется, сон разрешен всегда
 
 // ==== EEPROM =======================================
-#define ALARM_EEPROM_INDEX 50 // индекс в EEPROM для сохранения настроек будильника; индексы 96..99 заняты настройками часов
+#define ALARM_EEPROM_INDEX 50 // индекс в EEPROM настроек будильника прежних версий прошивки (только для их переноса в журнал); индексы 96..99 заняты настройками часов
+#define ALARM_LIST_EEPROM_INDEX 100 // индекс в EEPROM для сохранения списка точек срабатывания будильника (до 65 байт)
+#define ALARM_JOURNAL_EEPROM_INDEX 170 // индекс в EEPROM для журнала настроек будильника (при настройках по умолчанию - 224 байта, до индекса 394)
+#define ALARM_DAYS_EEPROM_INDEX 400 // индекс в EEPROM для наборов промежутков будильника по дням недели (7 байт)
+#define ALARM_HOLIDAYS_EEPROM_INDEX 410 // индекс в EEPROM для календаря исключений будильника (46 байт)
+
+// ==== Serial =======================================
+#define USE_SERIAL_COMMANDS // настройка будильника командами через Serial (см. serial_commands.h)
+
+// ==== энергосбережение =============================
+// #define USE_POWER_SAVE // сон между событиями будильника с пробуждением по будильнику DS3231 или кнопке, статистика сна в Serial по команде 'w' (см. power_save.h)
+
+// ==== отладка ======================================
+// #define USE_BOOT_TIME_REPORT // вывод в Serial времени загрузки - от сброса до первого вызова saClock.tick()
+// #define USE_TRIGGER_STATS_REPORT // вывод в Serial статистики задержки срабатывания будильника по команде 't' (см. trigger_stats.h)
+// #define USE_TASK_PROFILER    // сбор статистики выполнения задач, вывод в Serial по команде 'p' (см. task_profiler.h)
+#define SERIAL_SPEED 9600 // скорость Serial для команд и вывода отладочной информации
+
+#if defined(USE_SERIAL_COMMANDS) || defined(USE_BOOT_TIME_REPORT) || \
+    defined(USE_TASK_PROFILER) || defined(USE_TRIGGER_STATS_REPORT) || \
+    defined(USE_POWER_SAVE)
+#define USE_SERIAL // Serial используется
+#endif
 
 // ===================================================
 clkHandle buttons_guard;           // опрос кнопок
@@ -16,7 +41,6 @@ clkHandle return_to_def_mode;      // таймер автовозврата в 
 clkHandle display_guard;           // вывод данных будильника на экран
 clkHandle alarm_guard;             // отслеживание будильника
 clkHandle alarm_buzzer;            // пищалка будильника
-clkHandle show_alarm_setting_mode; // режим показа текущих настроек будильника или списка точек срабатывания
 clkHandle set_alarm_mode;          // режим настройки будильника
 
 // ===================================================
@@ -25,13 +49,16 @@ enum saAlarmSettingDataType : uint8_t
 {
   ALARM_DATA_NO,
   ALARM_DATA_ON_OFF,
+  ALARM_DATA_WINDOW,
+  ALARM_DATA_WINDOW_ON_OFF,
   ALARM_DATA_HOUR_1,
   ALARM_DATA_MINUTE_1,
   ALARM_DATA_HOUR_2,
   ALARM_DATA_MINUTE_2,
   ALARM_DATA_INTERVAL,
   ALARM_DATA_NEXT_POINT,
-  ALARM_DATA_PONT_LIST
+  ALARM_DATA_PONT_LIST,
+  ALARM_DATA_TRIGGER_STATS
 };
 
 static saAlarmSettingDataType getNext(const saAlarmSettingDataType current)
@@ -40,6 +67,8 @@ static saAlarmSettingDataType getNext(const saAlarmSettingDataType current)
   {
   case ALARM_DATA_NO:
   case ALARM_DATA_ON_OFF:
+  case ALARM_DATA_WINDOW:
+  case ALARM_DATA_WINDOW_ON_OFF:
   case ALARM_DATA_HOUR_1:
   case ALARM_DATA_MINUTE_1:
   case ALARM_DATA_HOUR_2:
@@ -70,6 +99,7 @@ saAlarmSettingDataType operator++(saAlarmSettingDataType &obj, const int)
 }
 
 saAlarmSettingDataType saAlarmDataType = ALARM_DATA_NO;
+uint8_t saAlarmWindow = 0; // номер выбранного промежутка сигнализации
 
 // ===================================================
 
@@ -84,10 +114,18 @@ void setDisplayData();
 void checkAlarm();
 void runAlarmBuzzer();
 
+// ==== Serial =======================================
+void applyAlarmSettings();
+#if defined(USE_TASK_PROFILER) || defined(USE_TRIGGER_STATS_REPORT) || defined(USE_POWER_SAVE)
+bool runDebugCommand(char _cmd);
+#endif
+
 // ==== вывод данных =================================
 void showTimeData(uint8_t hour, uint8_t minute);
+void showNumber(uint16_t _num);
 void saveData(uint8_t h, uint8_t m);
 void showAlarmState(uint8_t _state);
+void showWindowState(uint8_t _window, uint8_t _state);
 void showSettingType(saAlarmSettingDataType _type);
 void checkData(uint8_t &dt, uint8_t max, bool toUp);
 void checkData(uint8_t &dt, uint8_t min, uint8_t max, uint8_t x, bool toUp);
@@ -0,0 +1,336 @@
+/**
+ * @file power_save.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Энергосберегающий режим - сон между событиями будильника;
+ *
+ *        включается строкой #define USE_POWER_SAVE в файле header_file.h;
+ *        после POWER_SAVE_IDLE_TIME бездействия в режиме показа времени
+ *        экран гасится, в будильник модуля DS3231 записывается время
+ *        ближайшего события, и микроконтроллер засыпает в режиме
+ *        power-down; разбудить его может сигнал с выхода INT/SQW модуля
+ *        RTC, подключенного к пину RTC_INT_PIN, или нажатие любой кнопки
+ *        (прерывания PCINT, см. button_events.h); во сне millis() стоит,
+ *        поэтому время сна считается по RTC;
+ *
+ *        на платформах, отличных от AVR, сон только имитируется: вместо
+ *        него вызывается функция, заданная setSimHook(), которая получает
+ *        время срабатывания будильника RTC, т.е. заменяет собой прерывание
+ *        RTC; это позволяет проверить расчет времени пробуждения и
+ *        посчитать долю времени бодрствования без железа;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include <shSimpleClock.h>
+#include "header_file.h"
+#include "button_events.h"
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
+#define POWER_SAVE_IDLE_TIME 10000ul // время бездействия перед засыпанием, мс
+#define POWER_SAVE_MIN_SLEEP 3       // минимальное время до события, при котором есть смысл засыпать, секунд
+#define POWER_SAVE_NO_ALARM 86400ul  // время до события, означающее, что будильник RTC не нужен
+
+#define DS3231_ADDRESS 0x68 // адрес DS3231 на шине I2C
+#define DS3231_ALARM_1 0x07 // первый регистр будильника 1
+#define DS3231_CONTROL 0x0E // регистр управления
+#define DS3231_STATUS 0x0F  // регистр состояния
+
+class PowerSave
+{
+private:
+  uint32_t idle_start;  // время начала бездействия, мс
+  uint32_t awake_start; // время последнего пробуждения, мс
+  uint32_t awake_time;  // суммарное время бодрствования до последнего сна, мс
+  uint32_t sleep_time;  // суммарное время сна, секунд
+  uint16_t sleep_count; // количество засыпаний
+  uint8_t rtc_control;  // регистр управления DS3231 до засыпания
+#if !defined(__AVR__)
+  void (*sim_hook)(uint32_t _wake_time);
+#endif
+
+  uint32_t getRtcTime();
+
+  void setRtcAlarm(uint32_t _time);
+
+  void clearRtcAlarm();
+
+#if defined(__AVR__)
+  uint8_t readRtc(uint8_t _reg);
+
+  void writeRtc(uint8_t _reg, uint8_t _data);
+#endif
+
+public:
+  PowerSave();
+
+  /**
+   * @brief настройка пина прерывания RTC; вызывается в setup() после
+   *        saButtons.begin()
+   */
+  void begin();
+
+  /**
+   * @brief сброс отсчета бездействия; вызывается, пока засыпать нельзя
+   */
+  void touch();
+
+  /**
+   * @brief проверка, можно ли засыпать - бездействие длится не меньше
+   *        POWER_SAVE_IDLE_TIME и нет внешнего питания
+   *
+   * @return true
+   * @return false
+   */
+  bool isIdle();
+
+  /**
+   * @brief сон до ближайшего события или нажатия кнопки
+   *
+   * @param _time текущее время в секундах от начала суток
+   * @param _delay время до события, секунд; POWER_SAVE_NO_ALARM - сон
+   *        только до нажатия кнопки
+   */
+  void sleep(uint32_t _time, uint32_t _delay);
+
+  /**
+   * @brief получение количества засыпаний
+   *
+   * @return uint16_t
+   */
+  uint16_t getSleepCount();
+
+  /**
+   * @brief получение суммарного времени сна
+   *
+   * @return uint32_t время, секунд
+   */
+  uint32_t getSleepTime();
+
+  /**
+   * @brief получение суммарного времени бодрствования
+   *
+   * @return uint32_t время, мс
+   */
+  uint32_t getAwakeTime();
+
+  /**
+   * @brief получение доли времени бодрствования
+   *
+   * @return uint16_t доля, промилле
+   */
+  uint16_t getDutyCycle();
+
+  /**
+   * @brief вывод статистики сна
+   *
+   * @param _out поток для вывода, например, Serial
+   */
+  void dump(Print &_out);
+
+#if !defined(__AVR__)
+  /**
+   * @brief установка функции, имитирующей сон и прерывание RTC
+   *
+   * @param _hook функция; получает время срабатывания будильника RTC в
+   *        секундах от начала суток или POWER_SAVE_NO_ALARM и должна
+   *        перевести часы ко времени пробуждения
+   */
+  void setSimHook(void (*_hook)(uint32_t _wake_time));
+#endif
+};
+
+// ---- private ---------------------------------
+
+uint32_t PowerSave::getRtcTime()
+{
+  clkDateTime dt = saClock.getCurrentDateTime();
+  return (dt.hour() * 3600ul + dt.minute() * 60ul + dt.second());
+}
+
+void PowerSave::setRtcAlarm(uint32_t _time)
+{
+#if defined(__AVR__)
+  uint8_t t[3] = {(uint8_t)(_time % 60), (uint8_t)(_time / 60 % 60), (uint8_t)(_time / 3600)};
+
+  // будильник 1 срабатывает каждые сутки при совпадении часов, минут и
+  // секунд (A1M4 = 1), сигнал выдается на выход INT/SQW (INTCN = 1, A1IE = 1)
+  rtc_control = readRtc(DS3231_CONTROL);
+  writeRtc(DS3231_STATUS, readRtc(DS3231_STATUS) & ~0x01);
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(DS3231_ALARM_1);
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    Wire.write(((t[i] / 10) << 4) | (t[i] % 10));
+  }
+  Wire.write(0x80);
+  Wire.endTransmission();
+  writeRtc(DS3231_CONTROL, rtc_control | 0x05);
+#else
+  (void)_time;
+#endif
+}
+
+void PowerSave::clearRtcAlarm()
+{
+#if defined(__AVR__)
+  writeRtc(DS3231_CONTROL, rtc_control);
+  writeRtc(DS3231_STATUS, readRtc(DS3231_STATUS) & ~0x01);
+#endif
+}
+
+#if defined(__AVR__)
+uint8_t PowerSave::readRtc(uint8_t _reg)
+{
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(_reg);
+  Wire.endTransmission();
+  Wire.requestFrom((uint8_t)DS3231_ADDRESS, (uint8_t)1);
+
+  return ((Wire.available()) ? Wire.read() : 0);
+}
+
+void PowerSave::writeRtc(uint8_t _reg, uint8_t _data)
+{
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(_reg);
+  Wire.write(_data);
+  Wire.endTransmission();
+}
+#endif
+
+// ---- public ----------------------------------
+
+PowerSave::PowerSave()
+{
+  idle_start = 0;
+  awake_start = 0;
+  awake_time = 0;
+  sleep_time = 0;
+  sleep_count = 0;
+  rtc_control = 0;
+#if !defined(__AVR__)
+  sim_hook = NULL;
+#endif
+}
+
+void PowerSave::begin()
+{
+#if defined(__AVR__)
+  // выход INT/SQW - открытый сток, активный уровень - низкий; прерывание
+  // PCINT только будит контроллер, обработчик для него - общий с кнопками
+  pinMode(RTC_INT_PIN, INPUT_PULLUP);
+  if (digitalPinToPCICR(RTC_INT_PIN) != NULL)
+  {
+    *digitalPinToPCMSK(RTC_INT_PIN) |= 1 << digitalPinToPCMSKbit(RTC_INT_PIN);
+    *digitalPinToPCICR(RTC_INT_PIN) |= 1 << digitalPinToPCICRbit(RTC_INT_PIN);
+  }
+#endif
+  if (POWER_SENSE_PIN >= 0)
+  {
+    pinMode(POWER_SENSE_PIN, INPUT);
+  }
+}
+
+void PowerSave::touch() { idle_start = millis(); }
+
+bool PowerSave::isIdle()
+{
+  if (POWER_SENSE_PIN >= 0 && digitalRead(POWER_SENSE_PIN) == HIGH)
+  { // есть внешнее питание
+    return (false);
+  }
+
+  return (millis() - idle_start >= POWER_SAVE_IDLE_TIME);
+}
+
+void PowerSave::sleep(uint32_t _time, uint32_t _delay)
+{
+  bool alarm = (_delay < POWER_SAVE_NO_ALARM);
+  uint32_t wake_time = (alarm) ? (_time + _delay) % 86400ul : POWER_SAVE_NO_ALARM;
+  if (alarm)
+  {
+    setRtcAlarm(wake_time);
+  }
+  awake_time += millis() - awake_start;
+
+#if defined(__AVR__)
+  uint8_t adc = ADCSRA;
+  ADCSRA = 0; // АЦП во сне не нужен
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  noInterrupts();
+  // если событие кнопки или сигнал RTC пришли до запрета прерываний, их
+  // прерывание уже отработало и разбудить контроллер будет некому
+  if (!saButtons.available() && (!alarm || digitalRead(RTC_INT_PIN) == HIGH))
+  {
+    sleep_enable();
+    interrupts(); // команда после sei выполняется до любого прерывания
+    sleep_cpu();
+    sleep_disable();
+  }
+  interrupts();
+  ADCSRA = adc;
+#else
+  if (sim_hook)
+  {
+    sim_hook(wake_time);
+  }
+#endif
+
+  if (alarm)
+  {
+    clearRtcAlarm();
+  }
+  sleep_count++;
+  sleep_time += (getRtcTime() + 86400ul - _time) % 86400ul;
+  awake_start = millis();
+  idle_start = awake_start;
+}
+
+uint16_t PowerSave::getSleepCount() { return (sleep_count); }
+
+uint32_t PowerSave::getSleepTime() { return (sleep_time); }
+
+uint32_t PowerSave::getAwakeTime() { return (awake_time + (millis() - awake_start)); }
+
+uint16_t PowerSave::getDutyCycle()
+{
+  // в секундах, а при долгой работе - с округлением знаменателя, чтобы не
+  // переполнить uint32_t
+  uint32_t awake = getAwakeTime() / 1000;
+  uint32_t total = awake + sleep_time;
+  if (total == 0)
+  {
+    return (1000);
+  }
+
+  return ((total < 4000000ul) ? awake * 1000 / total : awake / (total / 1000));
+}
+
+void PowerSave::dump(Print &_out)
+{
+  _out.print(F("sleeps;"));
+  _out.println(sleep_count);
+  _out.print(F("sleep_s;"));
+  _out.println(sleep_time);
+  _out.print(F("awake_ms;"));
+  _out.println(getAwakeTime());
+  _out.print(F("duty_permille;"));
+  _out.println(getDutyCycle());
+}
+
+#if !defined(__AVR__)
+void PowerSave::setSimHook(void (*_hook)(uint32_t _wake_time)) { sim_hook = _hook; }
+#endif
+
+// ===================================================
+
+PowerSave saPower;
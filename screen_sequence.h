@@ -0,0 +1,259 @@
+/**
+ * @file screen_sequence.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Последовательности информационных экранов будильника;
+ *
+ *        каждый экран описывается записью в PROGMEM: символы метки, источник
+ *        выводимого значения, время показа метки до и после значения, время
+ *        показа значения и следующий шаг; последовательность проигрывается
+ *        вызовом tick() из задачи display_guard, собственная задача ей не
+ *        нужна; чтобы добавить новый информационный экран, достаточно
+ *        добавить запись в таблицу screen_steps и, если нужно, источник
+ *        значения;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include "header_file.h"
+#include "alarm.h"
+#include <shSimpleClock.h>
+#include "trigger_stats.h"
+
+#define SCREEN_END 0xFF  // следующий шаг: конец последовательности
+#define SCREEN_LOOP 0xFE // следующий шаг: повтор шага со следующим значением источника, пока они не закончатся
+
+enum ScreenSource : uint8_t // источник значения, выводимого на экран
+{
+  SCREEN_SRC_POINT_1,    // начало выбранного промежутка
+  SCREEN_SRC_POINT_2,    // окончание выбранного промежутка
+  SCREEN_SRC_INTERVAL,   // интервал выбранного промежутка
+  SCREEN_SRC_NEXT_POINT, // время следующего срабатывания
+  SCREEN_SRC_POINT_LIST, // очередная точка срабатывания
+  // дальше - источники, значения которых выводятся числом, а не временем
+  SCREEN_SRC_RECENT_DELAY, // максимальная задержка последних срабатываний, мс
+  SCREEN_SRC_MAX_DELAY,    // максимальная задержка срабатывания, мс
+  SCREEN_SRC_MISSED        // количество пропущенных срабатываний
+};
+
+struct ScreenStep // шаг последовательности экранов
+{
+  uint8_t label[2];   // символы метки для первых двух разрядов
+  uint8_t source;     // источник значения, ScreenSource
+  uint8_t label_time; // время показа метки до значения, десятых секунды
+  uint8_t value_time; // время показа значения, десятых секунды
+  uint8_t tail_time;  // время показа метки после значения, десятых секунды
+  uint8_t next;       // номер следующего шага, SCREEN_END или SCREEN_LOOP
+};
+
+enum ScreenSequenceStart : uint8_t // первые шаги последовательностей
+{
+  SCREEN_SEQ_INFO = 0,       // текущие настройки: P1, P2, It, Pn
+  SCREEN_SEQ_NEXT_POINT = 3, // только время следующего срабатывания
+  SCREEN_SEQ_POINT_LIST = 4, // все точки срабатывания по очереди
+  SCREEN_SEQ_TRIGGER_STATS = 5 // статистика задержки срабатывания
+};
+
+static const ScreenStep PROGMEM screen_steps[] = {
+    {{0b01110011, 0b10000110}, SCREEN_SRC_POINT_1, 8, 12, 0, 1},             // P1:
+    {{0b01110011, 0b11011011}, SCREEN_SRC_POINT_2, 8, 12, 0, 2},             // P2:
+    {{0b00000110, 0b11111000}, SCREEN_SRC_INTERVAL, 8, 12, 0, 3},            // It:
+    {{0b01110011, 0b11010100}, SCREEN_SRC_NEXT_POINT, 8, 12, 0, SCREEN_END}, // Pn:
+    {{0x00, 0x00}, SCREEN_SRC_POINT_LIST, 4, 12, 4, SCREEN_LOOP},            // точки срабатывания
+    {{0b00111000, 0b11111000}, SCREEN_SRC_RECENT_DELAY, 8, 12, 0, 6},        // Lt:
+    {{0b00111000, 0b11110110}, SCREEN_SRC_MAX_DELAY, 8, 12, 0, 7},           // LH:
+    {{0b00111000, 0b11011100}, SCREEN_SRC_MISSED, 8, 12, 0, SCREEN_END}};    // Lo:
+
+class ScreenSequence
+{
+private:
+  ScreenStep cur;      // копия текущего шага из PROGMEM
+  uint8_t step;        // номер текущего шага
+  uint32_t step_start; // время начала показа текущего шага, мс
+  bool running;        // флаг проигрывания последовательности
+  AlarmCursor list_point; // очередная точка срабатывания для SCREEN_SRC_POINT_LIST
+
+  bool getValue(uint8_t _source, uint16_t &_value);
+
+  bool nextValue(uint8_t _source);
+
+  void enter(uint8_t _step);
+
+public:
+  ScreenSequence();
+
+  /**
+   * @brief начало проигрывания последовательности экранов
+   *
+   * @param _step первый шаг, ScreenSequenceStart
+   */
+  void start(uint8_t _step);
+
+  /**
+   * @brief остановка проигрывания последовательности
+   */
+  void stop();
+
+  /**
+   * @brief проверка, проигрывается ли последовательность
+   *
+   * @return true
+   * @return false
+   */
+  bool isRunning();
+
+  /**
+   * @brief вывод текущего экрана последовательности и переход к следующему
+   *        шагу по истечении времени показа
+   *
+   * @return true - последовательность продолжается
+   * @return false - последовательность закончилась
+   */
+  bool tick();
+};
+
+// ---- private ---------------------------------
+
+bool ScreenSequence::getValue(uint8_t _source, uint16_t &_value)
+{
+  // при одинаковом времени начала и окончания промежутка выводится только
+  // одно время, остальные экраны пропускаются; в режиме списка выводится
+  // только время следующего срабатывания
+  bool single = (saAlarm.getAlarmMode() == ALARM_MODE_INTERVAL) &&
+                (saAlarm.getAlarmPoint1(saAlarmWindow) == saAlarm.getAlarmPoint2(saAlarmWindow));
+
+  switch (_source)
+  {
+  case SCREEN_SRC_POINT_1:
+    _value = saAlarm.getAlarmPoint1(saAlarmWindow);
+    return (true);
+  case SCREEN_SRC_POINT_2:
+    _value = saAlarm.getAlarmPoint2(saAlarmWindow);
+    return (!single);
+  case SCREEN_SRC_INTERVAL:
+    _value = saAlarm.getAlarmInterval(saAlarmWindow);
+    return (!single);
+  case SCREEN_SRC_NEXT_POINT:
+    _value = saAlarm.getNextPoint();
+    return (!single && _value != ALARM_NO_POINT);
+  case SCREEN_SRC_POINT_LIST:
+    _value = list_point.point;
+    return (_value != ALARM_NO_POINT);
+  case SCREEN_SRC_RECENT_DELAY:
+    _value = saTriggerStats.getRecentMaxDelay();
+    return (true);
+  case SCREEN_SRC_MAX_DELAY:
+    _value = saTriggerStats.getMaxDelay();
+    return (true);
+  case SCREEN_SRC_MISSED:
+    _value = saAlarm.getMissedCount();
+    return (true);
+  default:
+    return (false);
+  }
+}
+
+bool ScreenSequence::nextValue(uint8_t _source)
+{
+  if (_source != SCREEN_SRC_POINT_LIST)
+  {
+    return (false);
+  }
+
+  // точки выводятся по кругу от начала первого включенного промежутка или
+  // первой точки списка, поэтому возврат к нему означает, что все точки уже
+  // показаны
+  saAlarm.nextPoint(list_point);
+  return (list_point.point != ALARM_NO_POINT &&
+          list_point.point != saAlarm.getFirstPoint());
+}
+
+void ScreenSequence::enter(uint8_t _step)
+{
+  uint16_t x;
+  // шаги, для которых нет значения, пропускаются
+  while (_step != SCREEN_END)
+  {
+    memcpy_P(&cur, &screen_steps[_step], sizeof(ScreenStep));
+    if (getValue(cur.source, x))
+    {
+      break;
+    }
+    _step = cur.next;
+  }
+
+  step = _step;
+  running = (step != SCREEN_END);
+  step_start = millis();
+}
+
+// ---- public ----------------------------------
+
+ScreenSequence::ScreenSequence()
+{
+  step = SCREEN_END;
+  step_start = 0;
+  running = false;
+  list_point.point = ALARM_NO_POINT;
+  list_point.left = 0;
+}
+
+void ScreenSequence::start(uint8_t _step)
+{
+  list_point = saAlarm.seekPoint(saAlarm.getFirstPoint() * 60ul);
+  enter(_step);
+}
+
+void ScreenSequence::stop() { running = false; }
+
+bool ScreenSequence::isRunning() { return (running); }
+
+bool ScreenSequence::tick()
+{
+  if (!running)
+  {
+    return (false);
+  }
+
+  uint16_t t = (millis() - step_start) / 100;
+  if (t >= cur.label_time + cur.value_time + cur.tail_time)
+  {
+    if (cur.next == SCREEN_LOOP)
+    {
+      enter((nextValue(cur.source)) ? step : SCREEN_END);
+    }
+    else
+    {
+      enter(cur.next);
+    }
+    if (!running)
+    {
+      return (false);
+    }
+    t = 0;
+  }
+
+  uint16_t x;
+  if (t >= cur.label_time && t < cur.label_time + cur.value_time && getValue(cur.source, x))
+  {
+    (cur.source >= SCREEN_SRC_RECENT_DELAY) ? showNumber(x) : showTimeData(x / 60, x % 60);
+  }
+  else
+  {
+    clkDisplay.setDispData(0, cur.label[0]);
+    clkDisplay.setDispData(1, cur.label[1]);
+    clkDisplay.setDispData(2, 0x00);
+    clkDisplay.setDispData(3, 0x00);
+  }
+
+  return (true);
+}
+
+// ===================================================
+
+ScreenSequence saScreens;
@@ -3,14 +3,41 @@
 #include "clockSetting.h"
 #include <shSimpleClock.h>
 #include "header_file.h"
+#include "time_source.h"
+#include "button_events.h"
+#include "buzzer.h"
 #include "alarm.h"
 #include "custom_display.h"
+#include "task_profiler.h"
+#include "trigger_stats.h"
+#include "serial_commands.h"
+#include "power_save.h"
 
 // ===================================================
 void checkButton()
 {
-  // если в данный момент сработал будильник, клик любой кнопкой отключает
-  // сигнализатор
+  static bool time_changed = false;
+  // кнопки, нажатием которых был отключен сигнализатор или набрана сервисная
+  // комбинация; до окончания работы с кнопками их клики больше никак не
+  // обрабатываются
+  static uint8_t ignored = 0;
+
+  // если в данный момент сработал будильник, нажатие любой кнопки сразу
+  // отключает сигнализатор, не дожидаясь распознавания клика библиотекой
+  ButtonEvent ev;
+  while (saButtons.getEvent(ev))
+  {
+    if (ev.pressed && saAlarm.getAlarmState() == ALARM_YES)
+    {
+      saAlarm.setAlarmState(ALARM_ON);
+      // обновить светодиод и пересчитать время следующей проверки
+      checkAlarm();
+      saButtons.setActionTime(ev.time);
+      ignored |= 1 << ev.button;
+    }
+  }
+
+  // то же по событиям библиотеки - для кнопок на пинах без прерываний PCINT
   if (saAlarm.getAlarmState() == ALARM_YES)
   {
     for (uint8_t i = 0; i < 3; i++)
@@ -21,17 +48,25 @@ void checkButton()
       {
         saAlarm.setAlarmState(ALARM_ON);
         saClock.resetButtonState(btn);
+        checkAlarm();
         return;
       }
     }
   }
 
-  static bool time_changed = false;
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    if (ignored & (1 << i))
+    {
+      saClock.resetButtonState((clkButtonType)i);
+    }
+  }
 
   if (time_changed)
   {
     // переинициализировать будильник, если время было изменено
-    saAlarm.init(saClock.getCurrentDateTime());
+    saTime.sync();
+    applyAlarmSettings();
     time_changed = false;
   }
 
@@ -39,6 +74,17 @@ void checkButton()
   {
   // в режиме показа времени
   case DISPLAY_MODE_SHOW_TIME:
+    // одновременное нажатие кнопок Set и Down выводит на экран статистику
+    // задержки срабатывания будильника
+    if (saClock.isButtonClosed(CLK_BTN_SET) && saClock.isButtonClosed(CLK_BTN_DOWN))
+    {
+      saClock.setDisplayMode(DISPLAY_MODE_CUSTOM_1);
+      saAlarmDataType = ALARM_DATA_TRIGGER_STATS;
+      ignored |= (1 << CLK_BTN_SET) | (1 << CLK_BTN_DOWN);
+      saClock.resetButtonState(CLK_BTN_SET);
+      saClock.resetButtonState(CLK_BTN_DOWN);
+      break;
+    }
     // кнопка Set
     switch (saClock.getButtonState(CLK_BTN_SET))
     {
@@ -62,7 +108,7 @@ void checkButton()
     // длинный клик выводит на экран все точки срабатывания будильника
     case BTN_LONGCLICK:
       if (saAlarm.getAlarmState() != ALARM_OFF &&
-          (saAlarm.getAlarmPoint1() != saAlarm.getAlarmPoint2()))
+          (saAlarm.getPointCount() > 1))
       {
         saClock.setDisplayMode(DISPLAY_MODE_CUSTOM_1);
         saAlarmDataType = ALARM_DATA_PONT_LIST;
@@ -94,7 +140,8 @@ void checkButton()
     // клик кнопкой Set возвращает в режим показа времени
     if (saClock.getButtonState(CLK_BTN_SET) == BTN_ONECLICK)
     {
-      saClock.stopTask(show_alarm_setting_mode);
+      saScreens.stop();
+      saAlarmDataType = ALARM_DATA_NO;
       saClock.setDisplayMode(DISPLAY_MODE_SHOW_TIME);
       saClock.resetButtonState(CLK_BTN_SET);
     }
@@ -103,6 +150,19 @@ void checkButton()
   default:
     break;
   }
+
+  // задача опроса кнопок работает только во время работы с кнопками и в
+  // режиме настройки времени; следующее нажатие запустит ее из loop()
+  if (!saButtons.isActive())
+  {
+    ignored = 0;
+    if (!time_changed &&
+        saClock.getDisplayMode() != DISPLAY_MODE_SET_HOUR &&
+        saClock.getDisplayMode() != DISPLAY_MODE_SET_MINUTE)
+    {
+      saClock.stopTask(buttons_guard);
+    }
+  }
 }
 
 void returnToDefaultMode()
@@ -120,14 +180,13 @@ void returnToDefaultMode()
 
 void setDisplayData()
 {
+  saAlarm.blinkLed();
+
   switch (saClock.getDisplayMode())
   {
   // режим вывода текущих настроек будильника или списка точек срабатывания
   case DISPLAY_MODE_CUSTOM_1:
-    if (!saClock.getTaskState(show_alarm_setting_mode))
-    {
-      showAlarmSetting();
-    }
+    PROFILED(PROF_SHOW_ALARM_SETTING_MODE, showAlarmSetting)();
     break;
   // режим настройки будильника
   case DISPLAY_MODE_CUSTOM_2:
@@ -147,66 +206,229 @@ void setDisplayData()
 
 void checkAlarm()
 {
-  saAlarm.tick(saClock.getCurrentDateTime());
-  if (saAlarm.getAlarmState() == ALARM_YES && !saClock.getTaskState(alarm_buzzer))
+  uint32_t tm = saTime.getTime();
+  // отметка времени для задержки срабатывания берется вместе с долей
+  // секунды до tick(): время чтения RTC в getTime() уже вошло в долю
+  // секунды, а время tick() и запуска пищалки войдет в millis() - ms
+  uint32_t ms = millis();
+  uint16_t frac = saTime.getFraction();
+  saAlarm.setDay(saTime.getDayOfWeek(), saTime.getDate());
+  saAlarm.tick(tm);
+  // запуск пищалки при срабатывании будильника или ее остановка, если
+  // сигнал отключен кнопкой
+  if ((saAlarm.getAlarmState() == ALARM_YES) != saClock.getTaskState(alarm_buzzer))
   {
     runAlarmBuzzer();
+    if (saAlarm.getAlarmState() == ALARM_YES)
+    { // сигнал только что запущен - задержка от начала секунды точки
+      // срабатывания до запуска пищалки; доля секунды известна, только если
+      // найдено начало секунды RTC
+      saTriggerStats.add(saAlarm.getTriggerDelay() * 1000ul + frac + (millis() - ms), saTime.isLocked());
+    }
   }
+
+  // задача просыпается только незадолго до ближайшего события - срабатывания
+  // будильника или смены цвета светодиода, в последние секунды перед ним
+  // проверки идут часто, чтобы не пропустить нужную секунду
+  uint32_t x = saAlarm.getTimeToEvent(tm);
+  if (x > ALARM_GUARD_MAX_SLEEP)
+  {
+    x = ALARM_GUARD_MAX_SLEEP;
+  }
+
+  // таймер задач идет от millis(), поэтому просыпаемся с запасом на его
+  // расхождение с RTC
+  x = (x > ALARM_GUARD_FINE_TIME + x / 64) ? (x - ALARM_GUARD_FINE_TIME - x / 64) * 1000ul
+                                           : ALARM_GUARD_FINE_INTERVAL;
+  saClock.setTaskInterval(alarm_guard, x, true);
+  PROFILER_SET_INTERVAL(PROF_ALARM_GUARD, x);
 }
 
 void runAlarmBuzzer()
 {
-  static uint8_t n = 0;
-  static uint8_t k = 0;
-  // "мелодия" пищалки: первая строка - частота, вторая строка - длительность
-  static const PROGMEM uint32_t pick[2][8] = {
-      {2000, 0, 2000, 0, 2000, 0, 2000, 0},
-      {70, 70, 70, 70, 70, 70, 70, 510}};
-
+  // мелодию проигрывает saBuzzer по прерыванию таймера, задача только
+  // запускает ее и следит за ее окончанием
   if (!saClock.getTaskState(alarm_buzzer))
   {
+    saBuzzer.start(saAlarm.getAlarmMelody(), saAlarm.getAlarmDuration());
     saClock.startTask(alarm_buzzer);
-    n = 0;
-    k = 0;
   }
   else if (saAlarm.getAlarmState() != ALARM_YES)
   { // остановка пищалки, если будильник отключен
+    saBuzzer.stop();
+    saClock.stopTask(alarm_buzzer);
+  }
+  else if (!saBuzzer.isRunning())
+  { // сигнал звучал заданное время
     saClock.stopTask(alarm_buzzer);
+    saAlarm.setAlarmState(ALARM_ON);
+    checkAlarm();
+  }
+}
+
+void applyAlarmSettings()
+{
+  // переинициализация будильника после изменения настроек или времени
+  uint32_t tm = saTime.getTime();
+  saAlarm.setDay(saTime.getDayOfWeek(), saTime.getDate());
+  saAlarm.init(tm);
+  checkAlarm();
+}
+
+#if defined(USE_TASK_PROFILER) || defined(USE_TRIGGER_STATS_REPORT) || defined(USE_POWER_SAVE)
+bool runDebugCommand(char _cmd)
+{
+  // однобуквенные команды отладки из Serial
+  switch (_cmd)
+  {
+#ifdef USE_TASK_PROFILER
+  case 'p':
+    saProfiler.dump(Serial);
+    return (true);
+  case 'r':
+    saProfiler.reset();
+    return (true);
+#endif
+#ifdef USE_TRIGGER_STATS_REPORT
+  case 't':
+    saTriggerStats.dump(Serial);
+    return (true);
+#endif
+#ifdef USE_POWER_SAVE
+  case 'w':
+    saPower.dump(Serial);
+    return (true);
+#endif
+  default:
+    return (false);
+  }
+}
+#endif
+
+#ifdef USE_POWER_SAVE
+void checkPowerSave()
+{
+  // засыпать можно только в режиме показа времени, когда не звучит сигнал
+  // и все данные записаны в EEPROM; отсчет бездействия после нажатия кнопок
+  // сбрасывается в loop()
+  bool busy = saClock.getDisplayMode() != DISPLAY_MODE_SHOW_TIME ||
+              saAlarm.getAlarmState() == ALARM_YES ||
+              !saEepromQueue.isEmpty() || saAlarm.isWritePending();
+#ifdef USE_SERIAL
+  busy = busy || Serial.available();
+#endif
+  if (busy)
+  {
+    saPower.touch();
     return;
   }
 
-  tone(ALARM_BUZZER_PIN, pgm_read_dword(&pick[0][n]), pgm_read_dword(&pick[1][n]));
-  saClock.setTaskInterval(alarm_buzzer, pgm_read_dword(&pick[1][n]), true);
-  if (++n >= 8)
+  // время запрашивается только когда засыпать уже можно - loop() проходит
+  // сюда постоянно, а запрос может обернуться чтением RTC
+  if (!saPower.isIdle())
   {
-    n = 0;
-    if (++k >= ALARM_DURATION)
-    { // остановка пищалки через заданное число секунд
-      k = 0;
-      saClock.stopTask(alarm_buzzer);
-      saClock.setTaskInterval(alarm_buzzer, 50, false);
-      saAlarm.setAlarmState(ALARM_ON);
-    }
+    return;
+  }
+  uint32_t tm = saTime.getTime();
+  uint32_t x = saAlarm.getTimeToEvent(tm);
+  if (x < POWER_SAVE_MIN_SLEEP)
+  {
+    return;
+  }
+
+#ifdef USE_SERIAL
+  Serial.flush();
+#endif
+  // на время сна экран гасится
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    clkDisplay.setDispData(i, 0x00);
   }
+  clkDisplay.show();
+
+  saPower.sleep(tm, x);
+
+  // millis() во сне стоял, поэтому время сразу берется из RTC, будильник
+  // проверяется сразу же, а экран библиотека перерисует целиком
+  saTime.sync();
+  checkAlarm();
 }
+#endif
 
 // ===================================================
+// время загрузки - от сброса до первого вызова saClock.tick(), мкс; отсчет
+// micros() начинается при запуске таймера ядром Arduino сразу после сброса,
+// еще до setup(), поэтому настройки загружаются не в конструкторах, а здесь
+uint32_t saBootTime = 0;
+
 void setup()
 {
-  saClock.setAdditionalTaskCount(7);
+#ifdef USE_SERIAL
+  Serial.begin(SERIAL_SPEED);
+#endif
+
+  saClock.setAdditionalTaskCount(6);
   saClock.init();
-  saAlarm.init(saClock.getCurrentDateTime());
-
-  return_to_def_mode = saClock.addAdditionalTask(AUTO_EXIT_TIMEOUT * 1000ul, returnToDefaultMode, false);
-  show_alarm_setting_mode = saClock.addAdditionalTask(100ul, showAlarmSetting, false);
-  display_guard = saClock.addAdditionalTask(50ul, setDisplayData);
-  alarm_guard = saClock.addAdditionalTask(200ul, checkAlarm);
-  alarm_buzzer = saClock.addAdditionalTask(50ul, runAlarmBuzzer, false);
-  set_alarm_mode = saClock.addAdditionalTask(100, showAlarmSettingInterface, false);
-  buttons_guard = saClock.addAdditionalTask(1, checkButton);
+  saButtons.begin();
+#ifdef USE_POWER_SAVE
+  saPower.begin();
+#endif
+  saAlarm.begin();
+  uint32_t tm = saTime.getTime();
+  saAlarm.setDay(saTime.getDayOfWeek(), saTime.getDate());
+  saAlarm.init(tm);
+
+  return_to_def_mode = saClock.addAdditionalTask(AUTO_EXIT_TIMEOUT * 1000ul, PROFILED(PROF_RETURN_TO_DEF_MODE, returnToDefaultMode), false);
+  display_guard = saClock.addAdditionalTask(50ul, PROFILED(PROF_DISPLAY_GUARD, setDisplayData));
+  alarm_guard = saClock.addAdditionalTask(ALARM_GUARD_FINE_INTERVAL, PROFILED(PROF_ALARM_GUARD, checkAlarm));
+  alarm_buzzer = saClock.addAdditionalTask(100ul, PROFILED(PROF_ALARM_BUZZER, runAlarmBuzzer), false);
+  set_alarm_mode = saClock.addAdditionalTask(100, PROFILED(PROF_SET_ALARM_MODE, showAlarmSettingInterface), false);
+  buttons_guard = saClock.addAdditionalTask(1, PROFILED(PROF_BUTTONS_GUARD, checkButton));
+
+  // return_to_def_mode - однократный таймер, опоздание для него не считается;
+  // экраны show_alarm_setting_mode выводятся на каждом запуске display_guard
+  PROFILER_SET_INTERVAL(PROF_SHOW_ALARM_SETTING_MODE, 50ul);
+  PROFILER_SET_INTERVAL(PROF_DISPLAY_GUARD, 50ul);
+  PROFILER_SET_INTERVAL(PROF_ALARM_GUARD, ALARM_GUARD_FINE_INTERVAL);
+  PROFILER_SET_INTERVAL(PROF_ALARM_BUZZER, 100ul);
+  PROFILER_SET_INTERVAL(PROF_SET_ALARM_MODE, 100ul);
+  PROFILER_SET_INTERVAL(PROF_BUTTONS_GUARD, 1ul);
 }
 
 void loop()
 {
+  if (!saBootTime)
+  { // первый проход loop() - загрузка завершена
+    saBootTime = micros();
+#ifdef USE_BOOT_TIME_REPORT
+    Serial.print(F("Boot time, us: "));
+    Serial.println(saBootTime);
+#endif
+  }
+
+  if (saButtons.available())
+  { // работа с кнопками началась - события обрабатываются сразу, а задача
+    // опроса кнопок запускается до ее окончания
+    if (!saClock.getTaskState(buttons_guard))
+    {
+      saClock.startTask(buttons_guard);
+    }
+#ifdef USE_POWER_SAVE
+    saPower.touch();
+#endif
+    checkButton();
+  }
+
   saClock.tick();
+  saEepromQueue.tick();
+  saAlarm.writePending();
+  saBuzzer.tick();
+#ifdef USE_POWER_SAVE
+  checkPowerSave();
+#endif
+#if defined(USE_SERIAL_COMMANDS)
+  saCommands.tick();
+#elif defined(USE_TASK_PROFILER) || defined(USE_TRIGGER_STATS_REPORT) || defined(USE_POWER_SAVE)
+  runDebugCommand(Serial.read());
+#endif
 }
@@ -0,0 +1,532 @@
+/**
+ * @file serial_commands.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Командный интерфейс Serial для настройки будильника;
+ *
+ *        команда - строка из буквы и чисел, разделенных пробелами или
+ *        запятыми; строка разбирается по мере поступления символов, без
+ *        буфера строки и без String, символы берутся из кольцевого буфера
+ *        приема ядра Arduino не больше SERIAL_COMMANDS_CHUNK за один вызов
+ *        tick(); на каждую строку выдается ответ OK или ERR;
+ *
+ *        команды:
+ *        ?                 - вывод всех настроек в виде команд; вывод можно
+ *                            сохранить и затем отправить обратно целиком
+ *        B                 - начало пакета изменений
+ *        E                 - окончание пакета изменений
+ *        A on              - включение/отключение будильника (0..1)
+ *        M mode            - режим работы будильника, AlarmMode (0..1)
+ *        W n on p1 p2 it   - промежуток n: включен/нет, начало и окончание
+ *                            в минутах от полуночи, интервал в минутах;
+ *                            последний включенный промежуток выключить
+ *                            нельзя - ответ ERR
+ *        Z melody duration - мелодия пищалки и продолжительность сигнала, сек
+ *        D d mask          - промежутки, действующие в день недели d (0 -
+ *                            воскресенье), битовая маска; в режиме списка
+ *                            0 - список в этот день отключен
+ *        H m d on          - отметка даты (месяц, число) в календаре
+ *                            исключений (0..1); H без чисел очищает календарь
+ *        L p ...           - новый список точек срабатывания, минут от
+ *                            полуночи; L без чисел очищает список
+ *        P p ...           - добавление точек в список срабатывания
+ *
+ *        все изменения между B и E применяются одним пакетом: одна запись
+ *        журнала настроек и списка точек в EEPROM и одна переинициализация
+ *        будильника; команда вне пакета применяется сразу после окончания
+ *        строки; если пакет не закрыт в течение SERIAL_COMMANDS_TIMEOUT,
+ *        он закрывается автоматически, а строка, не законченная за это
+ *        время, отбрасывается;
+ *
+ *        ответы выводятся, только если в буфере передачи Serial есть место,
+ *        а пока ответ не выведен, прием не разбирается, поэтому tick() не
+ *        ждет передачи ни при каком объеме команд;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include "header_file.h"
+#include "time_source.h"
+#include "alarm.h"
+#include "buzzer.h"
+
+#define SERIAL_COMMANDS_CHUNK 32        // максимальное количество символов, разбираемых за один вызов tick()
+#define SERIAL_COMMANDS_MAX_ARGS 5      // максимальное количество чисел в команде, кроме списка точек
+#define SERIAL_COMMANDS_LINE_SIZE 48    // максимальная длина строки ответа, байт
+#define SERIAL_COMMANDS_LIST_LINE 8     // количество точек в одной строке вывода списка
+#define SERIAL_COMMANDS_TIMEOUT 5000    // время ожидания окончания пакета изменений, мс
+
+enum SerialCommandReply : uint8_t // ответ, ожидающий вывода
+{
+  CMD_REPLY_NO,
+  CMD_REPLY_OK,
+  CMD_REPLY_ERR
+};
+
+class SerialCommands
+{
+private:
+  char cmd;                               // буква текущей команды, 0 - команда еще не получена
+  uint8_t argc;                           // количество полученных чисел
+  union
+  {
+    uint16_t args[SERIAL_COMMANDS_MAX_ARGS]; // числа текущей команды
+    uint16_t points[ALARM_LIST_SIZE];        // новый список точек срабатывания для команд L и P
+  };
+  uint16_t num;                           // разбираемое число
+  bool has_num;                           // флаг наличия разбираемого числа
+  bool error;                             // флаг ошибки в текущей строке
+  bool in_batch;                          // флаг открытого командой B пакета изменений
+  bool changed;                           // флаг наличия изменений в текущем пакете
+  uint32_t last_time;                     // время получения последнего символа, мс
+  uint8_t reply;                          // ответ, ожидающий вывода, SerialCommandReply
+  uint8_t dump_step;                      // очередная строка вывода настроек, 0 - вывода нет
+  uint16_t dump_date;                     // очередная дата при выводе календаря исключений
+
+  void parse(char _c);
+
+  void onNumber();
+
+  void execute();
+
+  void clearLine();
+
+  void open();
+
+  void commit();
+
+  bool isSetting(char _cmd);
+
+  bool printNext();
+
+  bool nextHoliday();
+
+public:
+  SerialCommands();
+
+  /**
+   * @brief прием и выполнение команд; вызывается из loop()
+   */
+  void tick();
+};
+
+// ---- private ---------------------------------
+
+void SerialCommands::parse(char _c)
+{
+  if (_c == '\n' || _c == '\r')
+  {
+    onNumber();
+    if (cmd || error)
+    {
+      execute();
+    }
+    clearLine();
+    return;
+  }
+
+  if (_c == ' ' || _c == ',' || _c == '\t')
+  {
+    onNumber();
+  }
+  else if (_c >= '0' && _c <= '9')
+  {
+    // числа больше 9999 командам не нужны, поэтому переполнение - ошибка
+    if (!cmd || num > 999)
+    {
+      error = true;
+    }
+    num = num * 10 + (_c - '0');
+    has_num = true;
+  }
+  else if (!cmd)
+  {
+    cmd = _c;
+    if (cmd == 'P')
+    { // точки добавляются к текущему списку
+      for (argc = 0; argc < saAlarm.getListCount(); argc++)
+      {
+        points[argc] = saAlarm.getListPoint(argc);
+      }
+    }
+  }
+  else
+  {
+    error = true;
+  }
+}
+
+void SerialCommands::onNumber()
+{
+  if (!has_num)
+  {
+    return;
+  }
+
+  // точки списка собираются в points без повторов и передаются будильнику
+  // только после окончания строки, если в ней нет ошибок; их количество в
+  // строке ограничено только размером списка
+  if (cmd == 'L' || cmd == 'P')
+  {
+    uint8_t i = 0;
+    while (i < argc && points[i] != num)
+    {
+      i++;
+    }
+    if (num > MAX_DATA || (i == argc && argc >= ALARM_LIST_SIZE))
+    {
+      error = true;
+    }
+    else if (i == argc)
+    {
+      points[argc++] = num;
+    }
+  }
+  else if (argc < SERIAL_COMMANDS_MAX_ARGS)
+  {
+    args[argc++] = num;
+  }
+  else
+  {
+    error = true;
+  }
+  num = 0;
+  has_num = false;
+}
+
+void SerialCommands::execute()
+{
+  bool result = !error;
+
+  // пакетное изменение открывается только для полностью принятой строки,
+  // поэтому оборванная строка не оставляет будильник с отложенной записью
+  if (result && isSetting(cmd))
+  {
+    open();
+  }
+
+  if (result)
+  {
+    switch (cmd)
+    {
+    case '?':
+      dump_step = 1;
+      break;
+    case 'B':
+      in_batch = true;
+      break;
+    case 'E':
+      in_batch = false;
+      break;
+    case 'A':
+      result = (argc == 1 && args[0] <= 1);
+      if (result)
+      {
+        saAlarm.setOnOffAlarm(args[0]);
+      }
+      break;
+    case 'M':
+      result = (argc == 1 && args[0] <= ALARM_MODE_LIST);
+      if (result)
+      {
+        saAlarm.setAlarmMode((AlarmMode)args[0]);
+      }
+      break;
+    case 'W':
+      result = (argc == 5 &&
+                args[0] < ALARM_WINDOW_COUNT &&
+                args[1] <= 1 &&
+                args[2] <= MAX_DATA &&
+                args[3] <= MAX_DATA &&
+                args[4] >= MIN_INTERVAL && args[4] <= MAX_INTERVAL);
+      // последний включенный промежуток выключить нельзя - строка
+      // отклоняется целиком
+      result = result && saAlarm.setOnOffWindow(args[0], args[1]);
+      if (result)
+      {
+        saAlarm.setAlarmPoint1(args[2], args[0]);
+        saAlarm.setAlarmPoint2(args[3], args[0]);
+        saAlarm.setAlarmInterval(args[4], args[0]);
+      }
+      break;
+    case 'Z':
+      result = (argc == 2 &&
+                args[0] < BUZZER_MELODY_COUNT &&
+                args[1] > 0 && args[1] <= ALARM_MAX_DURATION);
+      if (result)
+      {
+        saAlarm.setAlarmMelody(args[0]);
+        saAlarm.setAlarmDuration(args[1]);
+      }
+      break;
+    case 'D':
+      result = (argc == 2 &&
+                args[0] < ALARM_DAY_COUNT &&
+                args[1] <= ALARM_ALL_WINDOWS);
+      if (result)
+      {
+        saAlarm.setDayWindows(args[0], args[1]);
+      }
+      break;
+    case 'H':
+      if (argc == 0)
+      {
+        saAlarm.clearHolidays();
+        break;
+      }
+      result = (argc == 3 && args[1] <= 31 && args[2] <= 1);
+      if (result)
+      {
+        result = saAlarm.setHoliday(getDateIndex(args[0], args[1]), args[2]);
+      }
+      break;
+    case 'L':
+    case 'P':
+      saAlarm.setPointList(points, argc);
+      // список точек может быть отключен в конфигурации будильника
+      result = (saAlarm.getListCount() == argc);
+      break;
+    default:
+#if defined(USE_TASK_PROFILER) || defined(USE_TRIGGER_STATS_REPORT) || defined(USE_POWER_SAVE)
+      // отладочные команды выводят данные сами и ответа не получают
+      if (argc == 0 && runDebugCommand(cmd))
+      {
+        return;
+      }
+#endif
+      result = false;
+      break;
+    }
+  }
+
+  if (!in_batch)
+  {
+    commit();
+  }
+  if (dump_step == 0)
+  { // после вывода настроек OK выводится последней строкой
+    reply = (result) ? CMD_REPLY_OK : CMD_REPLY_ERR;
+  }
+}
+
+void SerialCommands::clearLine()
+{
+  cmd = 0;
+  argc = 0;
+  num = 0;
+  has_num = false;
+  error = false;
+}
+
+void SerialCommands::open()
+{
+  if (!changed)
+  {
+    saAlarm.beginUpdate();
+    changed = true;
+  }
+}
+
+void SerialCommands::commit()
+{
+  in_batch = false;
+  if (changed)
+  {
+    changed = false;
+    saAlarm.endUpdate();
+    applyAlarmSettings();
+  }
+}
+
+bool SerialCommands::isSetting(char _cmd)
+{
+  return (_cmd == 'A' || _cmd == 'M' || _cmd == 'W' || _cmd == 'Z' ||
+          _cmd == 'D' || _cmd == 'H' || _cmd == 'L' || _cmd == 'P');
+}
+
+bool SerialCommands::printNext()
+{
+  if (Serial.availableForWrite() < SERIAL_COMMANDS_LINE_SIZE)
+  {
+    return (false);
+  }
+
+  // строки: A, M, W для каждого промежутка (сначала включенные), Z, D для
+  // каждого дня недели,
+  // H и по строке на каждую дату календаря исключений, затем список точек
+  // по SERIAL_COMMANDS_LIST_LINE в строке
+  uint8_t step = dump_step++;
+  if (step == 1)
+  {
+    Serial.print(F("A "));
+    Serial.println(saAlarm.getOnOffAlarm());
+  }
+  else if (step == 2)
+  {
+    Serial.print(F("M "));
+    Serial.println(saAlarm.getAlarmMode());
+  }
+  else if (step < 3 + ALARM_WINDOW_COUNT)
+  {
+    // включенные промежутки выводятся первыми, поэтому при отправке вывода
+    // обратно последний включенный промежуток не выключается ни на какой
+    // строке
+    uint8_t i = 0;
+    for (uint8_t j = 0, n = 0; j < 2 * ALARM_WINDOW_COUNT; j++)
+    {
+      if (saAlarm.getOnOffWindow(j % ALARM_WINDOW_COUNT) == (j < ALARM_WINDOW_COUNT) &&
+          n++ == step - 3)
+      {
+        i = j % ALARM_WINDOW_COUNT;
+        break;
+      }
+    }
+    Serial.print(F("W "));
+    Serial.print(i);
+    Serial.print(' ');
+    Serial.print(saAlarm.getOnOffWindow(i));
+    Serial.print(' ');
+    Serial.print(saAlarm.getAlarmPoint1(i));
+    Serial.print(' ');
+    Serial.print(saAlarm.getAlarmPoint2(i));
+    Serial.print(' ');
+    Serial.println(saAlarm.getAlarmInterval(i));
+  }
+  else if (step == 3 + ALARM_WINDOW_COUNT)
+  {
+    Serial.print(F("Z "));
+    Serial.print(saAlarm.getAlarmMelody());
+    Serial.print(' ');
+    Serial.println(saAlarm.getAlarmDuration());
+  }
+  else if (step < 4 + ALARM_WINDOW_COUNT + ALARM_DAY_COUNT)
+  {
+    uint8_t i = step - 4 - ALARM_WINDOW_COUNT;
+    Serial.print(F("D "));
+    Serial.print(i);
+    Serial.print(' ');
+    Serial.println(saAlarm.getDayWindows(i));
+  }
+  else if (step == 4 + ALARM_WINDOW_COUNT + ALARM_DAY_COUNT)
+  {
+    Serial.println('H');
+    dump_date = 0;
+  }
+  else if (step == 5 + ALARM_WINDOW_COUNT + ALARM_DAY_COUNT && nextHoliday())
+  { // даты выводятся по одной в строке, пока не кончатся
+    dump_step--;
+    uint8_t m = 1;
+    while (dump_date >= pgm_read_word(&month_start[m]))
+    {
+      m++;
+    }
+    Serial.print(F("H "));
+    Serial.print(m);
+    Serial.print(' ');
+    Serial.print(dump_date - pgm_read_word(&month_start[m - 1]) + 1);
+    Serial.println(F(" 1"));
+    dump_date++;
+  }
+  else
+  {
+    uint8_t first = (step - 5 - ALARM_WINDOW_COUNT - ALARM_DAY_COUNT) * SERIAL_COMMANDS_LIST_LINE;
+    if (first > 0 && first >= saAlarm.getListCount())
+    {
+      dump_step = 0;
+      reply = CMD_REPLY_OK;
+      return (true);
+    }
+    Serial.print((first == 0) ? 'L' : 'P');
+    for (uint8_t i = first; i < saAlarm.getListCount() && i < first + SERIAL_COMMANDS_LIST_LINE; i++)
+    {
+      Serial.print(' ');
+      Serial.print(saAlarm.getListPoint(i));
+    }
+    Serial.println();
+  }
+
+  return (true);
+}
+
+bool SerialCommands::nextHoliday()
+{
+  while (dump_date < ALARM_DATE_COUNT && !saAlarm.isHoliday(dump_date))
+  {
+    dump_date++;
+  }
+
+  return (dump_date < ALARM_DATE_COUNT);
+}
+
+// ---- public ----------------------------------
+
+SerialCommands::SerialCommands()
+{
+  cmd = 0;
+  argc = 0;
+  num = 0;
+  has_num = false;
+  error = false;
+  in_batch = false;
+  changed = false;
+  last_time = 0;
+  reply = CMD_REPLY_NO;
+  dump_step = 0;
+  dump_date = 0;
+}
+
+void SerialCommands::tick()
+{
+  // пока предыдущий ответ не выведен, новые команды не разбираются - они
+  // ждут в буфере приема
+  while (dump_step)
+  {
+    if (!printNext())
+    {
+      return;
+    }
+  }
+  if (reply)
+  {
+    if (Serial.availableForWrite() < SERIAL_COMMANDS_LINE_SIZE)
+    {
+      return;
+    }
+    Serial.println((reply == CMD_REPLY_OK) ? F("OK") : F("ERR"));
+    reply = CMD_REPLY_NO;
+  }
+
+  for (uint8_t i = 0; i < SERIAL_COMMANDS_CHUNK && Serial.available(); i++)
+  {
+    last_time = millis();
+    parse(Serial.read());
+    if (reply || dump_step)
+    {
+      break;
+    }
+  }
+
+  // незакрытый пакет применяется автоматически, чтобы будильник не остался
+  // с настройками, не записанными в EEPROM, а недописанная строка
+  // отбрасывается, чтобы не склеиться со следующей
+  if (millis() - last_time >= SERIAL_COMMANDS_TIMEOUT)
+  {
+    if (in_batch || changed)
+    {
+      commit();
+    }
+    if (cmd || has_num || error)
+    {
+      clearLine();
+    }
+  }
+}
+
+// ===================================================
+
+SerialCommands saCommands;
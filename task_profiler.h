@@ -0,0 +1,238 @@
+/**
+ * @file task_profiler.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Профилировщик дополнительных задач shSimpleClock;
+ *
+ *        включается строкой #define USE_TASK_PROFILER в файле header_file.h;
+ *        каждая задача регистрируется через обертку PROFILED(), которая
+ *        замеряет время выполнения задачи и ее опоздание относительно
+ *        интервала; по команде 'p', полученной через Serial, статистика
+ *        выводится в Serial, по команде 'r' - сбрасывается;
+ *
+ *        опоздание считается как превышение промежутка между двумя
+ *        последовательными запусками задачи над ее интервалом; промежутки
+ *        больше двух интервалов не учитываются - в этом случае задача,
+ *        скорее всего, была остановлена или перезапущена;
+ *
+ *        экраны настроек будильника и списка точек срабатывания выводятся
+ *        уже не отдельной задачей show_alarm_setting_mode, а из display_guard
+ *        (см. screen_sequence.h); их вывод замеряется под прежним именем
+ *        внутри display_guard, поэтому это время входит и во время
+ *        display_guard; замеры могут быть вложенными;
+ *
+ *        без USE_TASK_PROFILER обертки ничего не добавляют в прошивку;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include "header_file.h"
+
+enum ProfiledTask : uint8_t // задачи, для которых собирается статистика
+{
+  PROF_RETURN_TO_DEF_MODE,
+  PROF_SHOW_ALARM_SETTING_MODE,
+  PROF_DISPLAY_GUARD,
+  PROF_ALARM_GUARD,
+  PROF_ALARM_BUZZER,
+  PROF_SET_ALARM_MODE,
+  PROF_BUTTONS_GUARD,
+  PROF_TASK_COUNT
+};
+
+#ifdef USE_TASK_PROFILER
+
+struct TaskProfile // статистика задачи
+{
+  uint32_t interval;   // интервал задачи, мс
+  uint32_t count;      // количество вызовов
+  uint32_t total;      // суммарное время выполнения, мкс
+  uint32_t min_time;   // минимальное время выполнения, мкс
+  uint32_t max_time;   // максимальное время выполнения, мкс
+  uint32_t last_start; // время последнего запуска, micros(); от него же считается время выполнения
+  uint32_t late_count; // количество запусков, для которых посчитано опоздание
+  uint32_t late_total; // суммарное опоздание, мкс
+  uint32_t late_max;   // максимальное опоздание, мкс
+};
+
+static const char prof_name_0[] PROGMEM = "return_to_def_mode";
+static const char prof_name_1[] PROGMEM = "show_alarm_setting_mode";
+static const char prof_name_2[] PROGMEM = "display_guard";
+static const char prof_name_3[] PROGMEM = "alarm_guard";
+static const char prof_name_4[] PROGMEM = "alarm_buzzer";
+static const char prof_name_5[] PROGMEM = "set_alarm_mode";
+static const char prof_name_6[] PROGMEM = "buttons_guard";
+
+static const char *const prof_names[PROF_TASK_COUNT] PROGMEM = {
+    prof_name_0,
+    prof_name_1,
+    prof_name_2,
+    prof_name_3,
+    prof_name_4,
+    prof_name_5,
+    prof_name_6};
+
+class TaskProfiler
+{
+private:
+  TaskProfile task[PROF_TASK_COUNT];
+
+public:
+  TaskProfiler();
+
+  /**
+   * @brief установка интервала задачи для подсчета опоздания; вызывается
+   *        при регистрации задачи и при каждом изменении ее интервала
+   *
+   * @param _task задача, ProfiledTask
+   * @param _interval интервал, мс
+   */
+  void setInterval(uint8_t _task, uint32_t _interval);
+
+  /**
+   * @brief начало выполнения задачи
+   *
+   * @param _task задача, ProfiledTask
+   */
+  void begin(uint8_t _task);
+
+  /**
+   * @brief окончание выполнения задачи
+   *
+   * @param _task задача, ProfiledTask
+   */
+  void end(uint8_t _task);
+
+  /**
+   * @brief сброс статистики всех задач
+   */
+  void reset();
+
+  /**
+   * @brief вывод статистики всех задач
+   *
+   * @param _out поток для вывода, например, Serial
+   */
+  void dump(Print &_out);
+};
+
+// ---- public ----------------------------------
+
+TaskProfiler::TaskProfiler()
+{
+  for (uint8_t i = 0; i < PROF_TASK_COUNT; i++)
+  {
+    task[i].interval = 0;
+  }
+  reset();
+}
+
+void TaskProfiler::setInterval(uint8_t _task, uint32_t _interval) { task[_task].interval = _interval; }
+
+void TaskProfiler::begin(uint8_t _task)
+{
+  TaskProfile &t = task[_task];
+  uint32_t start_time = micros();
+
+  if (t.count && t.interval)
+  {
+    uint32_t gap = start_time - t.last_start;
+    uint32_t it = t.interval * 1000ul;
+    if (gap < it * 2)
+    {
+      uint32_t late = (gap > it) ? gap - it : 0;
+      t.late_count++;
+      t.late_total += late;
+      if (late > t.late_max)
+      {
+        t.late_max = late;
+      }
+    }
+  }
+  t.last_start = start_time;
+}
+
+void TaskProfiler::end(uint8_t _task)
+{
+  TaskProfile &t = task[_task];
+  uint32_t x = micros() - t.last_start;
+
+  t.count++;
+  t.total += x;
+  if (x < t.min_time)
+  {
+    t.min_time = x;
+  }
+  if (x > t.max_time)
+  {
+    t.max_time = x;
+  }
+}
+
+void TaskProfiler::reset()
+{
+  for (uint8_t i = 0; i < PROF_TASK_COUNT; i++)
+  {
+    TaskProfile &t = task[i];
+    t.count = 0;
+    t.total = 0;
+    t.min_time = 0xFFFFFFFF;
+    t.max_time = 0;
+    t.last_start = 0;
+    t.late_count = 0;
+    t.late_total = 0;
+    t.late_max = 0;
+  }
+}
+
+void TaskProfiler::dump(Print &_out)
+{
+  // задача; вызовов; время выполнения, мкс: всего, мин, макс; опоздание, мкс: среднее, макс
+  _out.println(F("task;count;total;min;max;late_avg;late_max"));
+  for (uint8_t i = 0; i < PROF_TASK_COUNT; i++)
+  {
+    TaskProfile &t = task[i];
+    _out.print((const __FlashStringHelper *)pgm_read_ptr(&prof_names[i]));
+    _out.print(';');
+    _out.print(t.count);
+    _out.print(';');
+    _out.print(t.total);
+    _out.print(';');
+    _out.print((t.count) ? t.min_time : 0);
+    _out.print(';');
+    _out.print(t.max_time);
+    _out.print(';');
+    _out.print((t.late_count) ? t.late_total / t.late_count : 0);
+    _out.print(';');
+    _out.println(t.late_max);
+  }
+}
+
+// ===================================================
+
+TaskProfiler saProfiler;
+
+template <uint8_t task, void (*callback)()>
+void profiledTask()
+{
+  saProfiler.begin(task);
+  callback();
+  saProfiler.end(task);
+}
+
+// регистрация задачи с замером времени ее выполнения
+#define PROFILED(task, callback) profiledTask<task, callback>
+// передача профилировщику нового интервала задачи
+#define PROFILER_SET_INTERVAL(task, interval) saProfiler.setInterval(task, interval)
+
+#else
+
+#define PROFILED(task, callback) callback
+#define PROFILER_SET_INTERVAL(task, interval)
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file bench_next_point.cpp
+ *
+ * @brief Сравнение скорости поиска ближайшей точки срабатывания:
+ *        seekPoint() и прежний цикл из init() (x += interval от начала
+ *        промежутка до текущего времени) для всех сочетаний начала, конца и
+ *        интервала одного промежутка;
+ *
+ *        настройки меняются в режиме обновления, план дня при этом не
+ *        перестраивается, поэтому точка ищется по новым настройкам, а
+ *        количество оставшихся точек (left) считается по старому плану - для
+ *        замера времени это не важно;
+ *
+ *        результаты не сравниваются - прежний цикл ошибался для промежутков
+ *        через полночь, правильность seekPoint() проверяет
+ *        verify_schedule
+ *
+ */
+#include "sim.h"
+#include <time.h>
+
+#define DAY_MINUTES (MAX_DATA + 1)
+
+static volatile uint32_t sink;
+
+// прежний поиск из SerialAlarm::init()
+static uint16_t loopNextPoint(uint16_t _p1, uint16_t _p2, uint16_t _interval, uint32_t _time)
+{
+  if (_p2 < _p1)
+  {
+    _time += DAY_MINUTES * 60ul;
+  }
+
+  uint16_t x = _p1;
+  while (x * 60ul < _time)
+  {
+    x += _interval;
+  }
+  if (!saAlarm.checkForInterval(x))
+  {
+    x = _p1;
+  }
+
+  return (x);
+}
+
+// время запроса для сочетания - разное, чтобы попадать и в промежуток, и вне его
+static inline uint32_t queryTime(uint16_t _p1, uint16_t _p2)
+{
+  return ((_p1 * 7919ul + _p2 * 104729ul) % (DAY_MINUTES * 60ul));
+}
+
+// проход по всем сочетаниям; _mode: 0 - только смена настроек, 1 - прежний
+// цикл, 2 - seekPoint()
+static double run(uint8_t _mode)
+{
+  timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  uint32_t sum = 0;
+  for (uint16_t it = MIN_INTERVAL; it <= MAX_INTERVAL; it += 10)
+  {
+    saAlarm.setAlarmInterval(it, 0);
+    for (uint16_t p1 = 0; p1 < DAY_MINUTES; p1++)
+    {
+      saAlarm.setAlarmPoint1(p1, 0);
+      for (uint16_t p2 = 0; p2 < DAY_MINUTES; p2++)
+      {
+        saAlarm.setAlarmPoint2(p2, 0);
+        uint32_t tm = queryTime(p1, p2);
+        switch (_mode)
+        {
+        case 1:
+          sum += loopNextPoint(p1, p2, it, tm);
+          break;
+        case 2:
+          sum += saAlarm.seekPoint(tm).point;
+          break;
+        default:
+          sum += tm;
+          break;
+        }
+      }
+    }
+  }
+  sink = sum;
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  return ((t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+}
+
+int main()
+{
+  saAlarm.begin();
+  saAlarm.setAlarmMode(ALARM_MODE_INTERVAL);
+  saAlarm.setOnOffWindow(0, true);
+  for (uint8_t i = 1; i < ALARM_WINDOW_COUNT; i++)
+  {
+    saAlarm.setOnOffWindow(i, false);
+  }
+  // настройки меняются без записи в EEPROM и без построения плана дня
+  saAlarm.beginUpdate();
+
+  uint32_t calls = ((MAX_INTERVAL - MIN_INTERVAL) / 10 + 1) * (uint32_t)DAY_MINUTES * DAY_MINUTES;
+  double base = run(0);
+  double loop = run(1) - base;
+  double calc = run(2) - base;
+  printf("bench_next_point: %lu calls, loop %.1f ns/call, seekPoint %.1f ns/call\n",
+         (unsigned long)calls, loop * 1e9 / calls, calc * 1e9 / calls);
+
+  return (0);
+}
@@ -0,0 +1,364 @@
+/**
+ * @file sim.h
+ *
+ * @brief Симулятор прошивки на компьютере;
+ *
+ *        скетч serial_alarm.ino собирается без изменений с заменами
+ *        библиотек из test/stubs; время виртуальное и идет скачками от
+ *        одного запуска задачи до следующего (миллисекундами, пока играет
+ *        пищалка, идет прием по Serial, запись в EEPROM или работа с
+ *        кнопками), поэтому сутки работы часов проходят за доли секунды;
+ *
+ *        записываются все запуски и остановки сигнала, звуки пищалки,
+ *        переключения светодиодов и кадры экрана; каждый тест - отдельная
+ *        программа, подключающая этот файл один раз
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <shSimpleClock.h>
+#include <vector>
+#include "serial_alarm.ino"
+
+// ==== замены библиотек =============================
+
+uint64_t sim_now_us = 0;
+uint8_t sim_eeprom[SIM_EEPROM_SIZE];
+uint32_t sim_eeprom_writes = 0;
+SimEEPROM EEPROM;
+SimDisplay clkDisplay;
+SimSerial Serial;
+
+// ==== события ======================================
+
+enum SimEventType : uint8_t
+{
+  SIM_EVENT_BUZZER, // запуск (1) или остановка (0) сигнала будильника
+  SIM_EVENT_TONE,   // звук пищалки, частота; 0 - тишина
+  SIM_EVENT_LED,    // светодиод: номер пина * 256 + уровень
+  SIM_EVENT_FRAME   // кадр экрана, 4 байта сегментов, первый - старший
+};
+
+struct SimEvent
+{
+  uint64_t rtc;       // время RTC, мс от начала 2026 г.
+  uint32_t ms;        // millis()
+  SimEventType type;  // тип события
+  uint32_t value;     // значение, см. SimEventType
+};
+
+std::vector<SimEvent> sim_events;
+
+static uint64_t sim_rtc_base = 0;      // время RTC на момент sim_rtc_origin, мс
+static uint64_t sim_rtc_origin = 0;    // момент установки RTC, мкс виртуального времени
+static int32_t sim_rtc_ppm = 0;        // уход RTC относительно millis(), миллионных долей
+static uint8_t sim_pins[64];           // уровни на выходах
+static uint8_t sim_inputs[64];         // уровни на входах, задает тест
+static unsigned int sim_tone = 0;      // текущая частота пищалки
+static uint32_t sim_frame = 0;         // последний выведенный кадр
+static bool sim_frame_valid = false;   // кадр уже выводился
+static bool sim_buzzer = false;        // сигнал будильника звучит
+static uint32_t sim_failures = 0;      // количество непрошедших проверок
+
+// в режиме показа времени, пока не звучит сигнал, проходы loop() ради
+// задачи display_guard пропускаются: она только мигает светодиодом
+// сработавшего будильника, а кадры библиотеки записываются с опозданием;
+// для долгих прогонов, в которых экран не проверяется
+bool sim_skip_display = false;
+
+static void simRecord(SimEventType _type, uint32_t _value)
+{
+  sim_events.push_back({simRtcMillis(), millis(), _type, _value});
+}
+
+uint64_t simRtcMillis()
+{
+  int64_t dt = (int64_t)(sim_now_us - sim_rtc_origin);
+  return (sim_rtc_base + (dt + dt * sim_rtc_ppm / 1000000) / 1000);
+}
+
+void simSetRtcMillis(uint64_t _ms)
+{
+  sim_rtc_base = _ms;
+  sim_rtc_origin = sim_now_us;
+}
+
+void simOnPinWrite(uint8_t _pin, uint8_t _state)
+{
+  _state = (_state) ? HIGH : LOW;
+  if (sim_pins[_pin] != _state)
+  {
+    sim_pins[_pin] = _state;
+    if (_pin == ALARM_RED_PIN || _pin == ALARM_GREEN_PIN)
+    {
+      simRecord(SIM_EVENT_LED, _pin * 256u + _state);
+    }
+  }
+}
+
+int simReadPin(uint8_t _pin) { return (sim_inputs[_pin]); }
+
+void simOnTone(unsigned int _frequency)
+{
+  if (sim_tone != _frequency)
+  {
+    sim_tone = _frequency;
+    simRecord(SIM_EVENT_TONE, _frequency);
+  }
+}
+
+void simOnDisplayShow(const uint8_t *_data)
+{
+  uint32_t x = ((uint32_t)_data[0] << 24) | ((uint32_t)_data[1] << 16) | (_data[2] << 8) | _data[3];
+  if (!sim_frame_valid || x != sim_frame)
+  {
+    sim_frame = x;
+    sim_frame_valid = true;
+    simRecord(SIM_EVENT_FRAME, x);
+  }
+}
+
+// ==== управление ===================================
+
+/**
+ * @brief установка даты и времени RTC; после запуска скетча, как и при
+ *        настройке часов кнопками, нужно еще вызвать simApplyTime()
+ */
+void simSetDateTime(uint16_t _y, uint8_t _mo, uint8_t _d, uint8_t _h, uint8_t _m, uint8_t _s,
+                    uint16_t _ms = 0)
+{
+  simSetRtcMillis(clkDateTime(_y, _mo, _d, _h, _m, _s).toSeconds() * 1000 + _ms);
+}
+
+/**
+ * @brief уход RTC относительно millis()
+ *
+ * @param _ppm миллионных долей, положительное значение - RTC спешит
+ */
+void simSetRtcDrift(int32_t _ppm)
+{
+  simSetRtcMillis(simRtcMillis());
+  sim_rtc_ppm = _ppm;
+}
+
+/**
+ * @brief время RTC в секундах от начала суток
+ */
+uint32_t simRtcTime() { return ((uint32_t)(simRtcMillis() / 1000 % 86400)); }
+
+/**
+ * @brief реакция скетча на изменение времени - как после настройки часов
+ *        кнопками
+ */
+void simApplyTime()
+{
+  saTime.sync();
+  applyAlarmSettings();
+}
+
+#if defined(USE_POWER_SAVE)
+static void simSleep(uint32_t _wake_time)
+{
+  // millis() во сне стоит, RTC идет до срабатывания своего будильника, а без
+  // него - до полуночи
+  uint64_t rtc = simRtcMillis();
+  uint32_t now = (uint32_t)(rtc / 1000 % 86400);
+  uint32_t x = (_wake_time < 86400ul) ? (_wake_time + 86400ul - now) % 86400ul : 86400ul - now;
+  if (x == 0)
+  {
+    x = 86400ul;
+  }
+  simSetRtcMillis((rtc / 1000 + x) * 1000 + 2);
+}
+#endif
+
+/**
+ * @brief запуск скетча - setup() и первый проход loop()
+ */
+void simBoot()
+{
+  setup();
+#if defined(USE_POWER_SAVE)
+  saPower.setSimHook(simSleep);
+#endif
+  loop();
+}
+
+static void simStep()
+{
+  loop();
+  if (saBuzzer.isRunning() != sim_buzzer)
+  {
+    sim_buzzer = saBuzzer.isRunning();
+    simRecord(SIM_EVENT_BUZZER, sim_buzzer);
+  }
+}
+
+/**
+ * @brief время до следующего прохода loop(), на котором что-то может
+ *        произойти, мкс
+ */
+static uint64_t simTimeToNext()
+{
+  if (saBuzzer.isRunning() || Serial.pending() || !saEepromQueue.isEmpty())
+  {
+    return (1000);
+  }
+  // опрос кнопок каждую миллисекунду нужен, только пока тест с ними
+  // работает, в остальное время задача выполняется на проходах loop() ради
+  // других задач
+  bool idle = saClock.isButtonIdle() && saClock.getDisplayMode() == DISPLAY_MODE_SHOW_TIME;
+  uint32_t except = (idle) ? 1ul << buttons_guard : 0;
+  if (idle && sim_skip_display)
+  {
+    except |= 1ul << display_guard;
+  }
+  uint64_t x = saClock.getTimeToNextTask(except);
+  return ((x) ? x * 1000 : 1000);
+}
+
+/**
+ * @brief работа скетча заданное время по millis()
+ *
+ * @param _ms продолжительность, мс
+ */
+void simRun(uint64_t _ms)
+{
+  uint64_t end = sim_now_us + _ms * 1000;
+  simStep();
+  while (sim_now_us < end)
+  {
+    uint64_t x = simTimeToNext();
+    sim_now_us = (end - sim_now_us > x) ? sim_now_us + x : end;
+    simStep();
+  }
+}
+
+/**
+ * @brief работа скетча, пока RTC не дойдет до заданного момента; в отличие
+ *        от simRun() учитывает время сна
+ *
+ * @param _rtc время RTC, мс от начала 2026 г.
+ */
+void simRunUntil(uint64_t _rtc)
+{
+  simStep();
+  while (simRtcMillis() < _rtc)
+  {
+    uint64_t x = simTimeToNext();
+    uint64_t left = (_rtc - simRtcMillis()) * 1000;
+    sim_now_us += (left > x) ? x : (left) ? left : 1000;
+    simStep();
+  }
+}
+
+/**
+ * @brief количество записанных событий заданного типа и значения
+ */
+uint32_t simCount(SimEventType _type, uint32_t _value)
+{
+  uint32_t n = 0;
+  for (size_t i = 0; i < sim_events.size(); i++)
+  {
+    n += (sim_events[i].type == _type && sim_events[i].value == _value);
+  }
+  return (n);
+}
+
+/**
+ * @brief время RTC в секундах от начала суток для события
+ */
+uint32_t simEventTime(const SimEvent &_event) { return ((uint32_t)(_event.rtc / 1000 % 86400)); }
+
+/**
+ * @brief запуски сигнала будильника
+ */
+std::vector<SimEvent> simAlarms()
+{
+  std::vector<SimEvent> x;
+  for (size_t i = 0; i < sim_events.size(); i++)
+  {
+    if (sim_events[i].type == SIM_EVENT_BUZZER && sim_events[i].value)
+    {
+      x.push_back(sim_events[i]);
+    }
+  }
+  return (x);
+}
+
+/**
+ * @brief передача строки в Serial и работа скетча, пока она не прочитана и
+ *        не обработана; возвращает все, что скетч за это время вывел
+ */
+std::string simSerial(const char *_s)
+{
+  Serial.output.clear();
+  Serial.send(_s);
+  while (Serial.pending())
+  {
+    simRun(1);
+  }
+  simRun(10);
+  return (Serial.output);
+}
+
+/**
+ * @brief запись всех данных из очереди в EEPROM
+ */
+void simFlushEeprom() { saEepromQueue.flush(); }
+
+// ==== проверки =====================================
+
+#define SIM_CHECK(cond)                                                 \
+  do                                                                    \
+  {                                                                     \
+    if (!(cond))                                                        \
+    {                                                                   \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);   \
+      sim_failures++;                                                   \
+    }                                                                   \
+  } while (0)
+
+#define SIM_CHECK_EQ(a, b)                                              \
+  do                                                                    \
+  {                                                                     \
+    long long sim_a = (long long)(a), sim_b = (long long)(b);           \
+    if (sim_a != sim_b)                                                 \
+    {                                                                   \
+      printf("%s:%d: check failed: %s == %s (%lld != %lld)\n",          \
+             __FILE__, __LINE__, #a, #b, sim_a, sim_b);                 \
+      sim_failures++;                                                   \
+    }                                                                   \
+  } while (0)
+
+#define SIM_CHECK_STR(a, b)                                             \
+  do                                                                    \
+  {                                                                     \
+    std::string sim_a = (a), sim_b = (b);                               \
+    if (sim_a != sim_b)                                                 \
+    {                                                                   \
+      printf("%s:%d: check failed: %s == %s (\"%s\" != \"%s\")\n",      \
+             __FILE__, __LINE__, #a, #b, sim_a.c_str(), sim_b.c_str()); \
+      sim_failures++;                                                   \
+    }                                                                   \
+  } while (0)
+
+/**
+ * @brief итог теста для main(); 0 - все проверки прошли
+ */
+int simResult(const char *_name)
+{
+  printf("%s: %s\n", _name, (sim_failures) ? "FAILED" : "OK");
+  return ((sim_failures) ? 1 : 0);
+}
+
+// чистая EEPROM и отпущенные кнопки на входах до запуска скетча
+static struct SimInit
+{
+  SimInit()
+  {
+    memset(sim_eeprom, 0xFF, sizeof(sim_eeprom));
+    memset(sim_inputs, HIGH, sizeof(sim_inputs));
+  }
+} sim_init;
@@ -0,0 +1,183 @@
+/**
+ * @file Arduino.h
+ *
+ * @brief Замена ядра Arduino для сборки прошивки на компьютере (см.
+ *        test/sim.h);
+ *
+ *        millis() и micros() идут от виртуального времени симулятора,
+ *        digitalWrite() и tone() передаются симулятору для записи событий,
+ *        Serial читает строки, заданные тестом, с темпом одного символа за
+ *        миллисекунду, как на скорости 9600;
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+
+#define PROGMEM
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define DEC 10
+#define HEX 16
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ==== виртуальное время и события, см. test/sim.h ====
+
+extern uint64_t sim_now_us; // время от запуска симулятора, мкс
+
+void simOnPinWrite(uint8_t _pin, uint8_t _state);
+void simOnTone(unsigned int _frequency);
+int simReadPin(uint8_t _pin);
+
+inline uint32_t millis() { return ((uint32_t)(sim_now_us / 1000)); }
+inline uint32_t micros() { return ((uint32_t)sim_now_us); }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t _pin, uint8_t _state) { simOnPinWrite(_pin, _state); }
+inline int digitalRead(uint8_t _pin) { return (simReadPin(_pin)); }
+
+inline void tone(uint8_t, unsigned int _frequency, unsigned long = 0) { simOnTone(_frequency); }
+inline void noTone(uint8_t) { simOnTone(0); }
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// ==== PROGMEM ======================================
+
+inline uint8_t pgm_read_byte(const void *_p) { return (*(const uint8_t *)_p); }
+inline uint16_t pgm_read_word(const void *_p) { return (*(const uint16_t *)_p); }
+inline uint32_t pgm_read_dword(const void *_p) { return (*(const uint32_t *)_p); }
+inline const void *pgm_read_ptr(const void *_p) { return (*(const void *const *)_p); }
+inline void *memcpy_P(void *_dst, const void *_src, size_t _n) { return (memcpy(_dst, _src, _n)); }
+
+class __FlashStringHelper;
+#define F(str) ((const __FlashStringHelper *)(str))
+
+// ==== Print и Serial ===============================
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t _c) = 0;
+
+  size_t print(const char *_s)
+  {
+    size_t n = 0;
+    while (*_s)
+    {
+      n += write(*_s++);
+    }
+    return (n);
+  }
+  size_t print(const __FlashStringHelper *_s) { return (print((const char *)_s)); }
+  size_t print(char _c) { return (write(_c)); }
+  size_t print(long long _x, int _base = DEC)
+  {
+    char buf[24];
+    snprintf(buf, sizeof(buf), (_base == HEX) ? "%llX" : "%lld", _x);
+    return (print(buf));
+  }
+  size_t print(int _x, int _base = DEC) { return (print((long long)_x, _base)); }
+  size_t print(unsigned int _x, int _base = DEC) { return (print((long long)_x, _base)); }
+  size_t print(long _x, int _base = DEC) { return (print((long long)_x, _base)); }
+  size_t print(unsigned long _x, int _base = DEC) { return (print((long long)_x, _base)); }
+  size_t print(unsigned char _x, int _base = DEC) { return (print((long long)_x, _base)); }
+  size_t print(short _x, int _base = DEC) { return (print((long long)_x, _base)); }
+  size_t print(unsigned short _x, int _base = DEC) { return (print((long long)_x, _base)); }
+  size_t print(signed char _x, int _base = DEC) { return (print((long long)_x, _base)); }
+
+  size_t println() { return (print("\r\n")); }
+  template <typename T>
+  size_t println(T _x) { return (print(_x) + println()); }
+  template <typename T>
+  size_t println(T _x, int _base) { return (print(_x, _base) + println()); }
+};
+
+class SimSerial : public Print
+{
+private:
+  std::string input;   // символы, переданные тестом
+  uint64_t input_time; // время появления первого из них в буфере приема, мкс
+
+public:
+  std::string output; // все, что прошивка вывела в Serial
+
+  SimSerial() : input_time(0) {}
+
+  void begin(unsigned long) {}
+  void flush() {}
+
+  /**
+   * @brief передача строки прошивке; символы поступают по одному в
+   *        миллисекунду начиная с текущего момента
+   */
+  void send(const char *_s)
+  {
+    if (input.empty())
+    {
+      input_time = sim_now_us;
+    }
+    input += _s;
+  }
+
+  /**
+   * @brief остались ли не прочитанные прошивкой символы
+   */
+  bool pending() { return (!input.empty()); }
+
+  int available()
+  {
+    if (input.empty() || sim_now_us < input_time)
+    {
+      return (0);
+    }
+    uint64_t n = (sim_now_us - input_time) / 1000 + 1;
+    if (n > input.size())
+    {
+      n = input.size();
+    }
+    return ((n > 64) ? 64 : (int)n);
+  }
+
+  int read()
+  {
+    if (!available())
+    {
+      return (-1);
+    }
+    uint8_t c = input[0];
+    input.erase(0, 1);
+    input_time += 1000;
+    return (c);
+  }
+
+  int peek() { return ((available()) ? (uint8_t)input[0] : -1); }
+
+  int availableForWrite() { return (63); }
+
+  size_t write(uint8_t _c) override
+  {
+    output += (char)_c;
+    return (1);
+  }
+
+  operator bool() { return (true); }
+};
+
+extern SimSerial Serial;
@@ -0,0 +1,61 @@
+/**
+ * @file EEPROM.h
+ *
+ * @brief Замена библиотеки EEPROM для сборки прошивки на компьютере;
+ *        объем - как у ATmega328, каждая физическая запись ячейки
+ *        подсчитывается
+ *
+ */
+#pragma once
+#include <stdint.h>
+
+#define SIM_EEPROM_SIZE 1024
+
+extern uint8_t sim_eeprom[SIM_EEPROM_SIZE]; // содержимое EEPROM
+extern uint32_t sim_eeprom_writes;          // количество записей ячеек
+
+class SimEEPROM
+{
+public:
+  uint8_t read(int _index) { return (sim_eeprom[_index]); }
+
+  void write(int _index, uint8_t _data)
+  {
+    sim_eeprom[_index] = _data;
+    sim_eeprom_writes++;
+  }
+
+  void update(int _index, uint8_t _data)
+  {
+    if (sim_eeprom[_index] != _data)
+    {
+      write(_index, _data);
+    }
+  }
+
+  template <typename T>
+  T &get(int _index, T &_t)
+  {
+    uint8_t *p = (uint8_t *)&_t;
+    for (unsigned i = 0; i < sizeof(T); i++)
+    {
+      p[i] = read(_index + i);
+    }
+    return (_t);
+  }
+
+  template <typename T>
+  const T &put(int _index, const T &_t)
+  {
+    const uint8_t *p = (const uint8_t *)&_t;
+    for (unsigned i = 0; i < sizeof(T); i++)
+    {
+      update(_index + i, p[i]);
+    }
+    return (_t);
+  }
+
+  uint16_t length() { return (SIM_EEPROM_SIZE); }
+};
+
+extern SimEEPROM EEPROM;
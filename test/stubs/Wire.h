@@ -0,0 +1,9 @@
+/**
+ * @file Wire.h
+ *
+ * @brief Замена библиотеки Wire для сборки прошивки на компьютере; шина I2C
+ *        используется прошивкой только на AVR, модуль RTC имитирует
+ *        shSimpleClock.h
+ *
+ */
+#pragma once
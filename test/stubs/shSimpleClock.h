@@ -0,0 +1,332 @@
+/**
+ * @file shSimpleClock.h
+ *
+ * @brief Замена библиотеки shSimpleClock для сборки прошивки на компьютере;
+ *
+ *        дополнительные задачи выполняются так же, как в библиотеке, - из
+ *        tick() по истечении интервала от millis(); модуль RTC идет от
+ *        виртуального времени симулятора (см. test/sim.h), начало отсчета -
+ *        1 января 2026 г., четверг; экран показывает время в режимах
+ *        библиотеки и передает симулятору каждый кадр, выведенный show();
+ *        кнопки задает тест
+ *
+ */
+#pragma once
+#include <Arduino.h>
+
+#define SIM_TASK_COUNT 16 // максимальное количество дополнительных задач
+
+// подключение и тип кнопок, см. clockSetting.h
+#define PULL_UP 0
+#define PULL_DOWN 1
+#define BTN_NO 0
+#define BTN_NC 1
+
+typedef int8_t clkHandle;
+
+enum clkButtonType : uint8_t
+{
+  CLK_BTN_SET,
+  CLK_BTN_UP,
+  CLK_BTN_DOWN
+};
+
+enum clkButtonState : uint8_t
+{
+  BTN_RELEASED,
+  BTN_DOWN,
+  BTN_DBLCLICK,
+  BTN_ONECLICK,
+  BTN_LONGCLICK
+};
+
+enum clkButtonFlag : uint8_t
+{
+  CLK_BTN_FLAG_NONE,
+  CLK_BTN_FLAG_NEXT,
+  CLK_BTN_FLAG_EXIT
+};
+
+enum clkDisplayMode : uint8_t
+{
+  DISPLAY_MODE_SHOW_TIME,
+  DISPLAY_MODE_SET_HOUR,
+  DISPLAY_MODE_SET_MINUTE,
+  DISPLAY_MODE_CUSTOM_1,
+  DISPLAY_MODE_CUSTOM_2
+};
+
+// ==== модуль RTC, см. test/sim.h ===================
+
+uint64_t simRtcMillis();
+void simSetRtcMillis(uint64_t _ms);
+
+class clkDateTime
+{
+private:
+  uint16_t y;
+  uint8_t mo, d, h, m, s, dw;
+
+  static bool isLeap(uint16_t _y) { return (_y % 4 == 0 && (_y % 100 != 0 || _y % 400 == 0)); }
+
+  static uint8_t monthLength(uint16_t _y, uint8_t _m)
+  {
+    static const uint8_t len[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return ((_m == 2 && isLeap(_y)) ? 29 : len[_m - 1]);
+  }
+
+public:
+  clkDateTime() : y(2026), mo(1), d(1), h(0), m(0), s(0), dw(4) {}
+
+  clkDateTime(uint16_t _y, uint8_t _mo, uint8_t _d, uint8_t _h, uint8_t _m, uint8_t _s)
+      : y(_y), mo(_mo), d(_d), h(_h), m(_m), s(_s)
+  {
+    dw = (3 + toSeconds() / 86400) % 7 + 1;
+  }
+
+  /**
+   * @brief дата и время по количеству секунд от начала 2026 г.
+   */
+  explicit clkDateTime(uint64_t _sec)
+  {
+    uint32_t days = (uint32_t)(_sec / 86400);
+    uint32_t t = (uint32_t)(_sec % 86400);
+    h = t / 3600;
+    m = t / 60 % 60;
+    s = t % 60;
+    dw = (3 + days) % 7 + 1; // 1 - понедельник, 7 - воскресенье
+    y = 2026;
+    while (days >= (isLeap(y) ? 366u : 365u))
+    {
+      days -= isLeap(y) ? 366 : 365;
+      y++;
+    }
+    mo = 1;
+    while (days >= monthLength(y, mo))
+    {
+      days -= monthLength(y, mo);
+      mo++;
+    }
+    d = days + 1;
+  }
+
+  /**
+   * @brief количество секунд от начала 2026 г.
+   */
+  uint64_t toSeconds()
+  {
+    uint64_t days = 0;
+    for (uint16_t i = 2026; i < y; i++)
+    {
+      days += isLeap(i) ? 366 : 365;
+    }
+    for (uint8_t i = 1; i < mo; i++)
+    {
+      days += monthLength(y, i);
+    }
+    days += d - 1;
+    return (days * 86400 + h * 3600ul + m * 60ul + s);
+  }
+
+  uint16_t year() { return (y); }
+  uint8_t month() { return (mo); }
+  uint8_t day() { return (d); }
+  uint8_t hour() { return (h); }
+  uint8_t minute() { return (m); }
+  uint8_t second() { return (s); }
+  uint8_t dayOfWeek() { return (dw); }
+};
+
+// ==== экран TM1637 =================================
+
+void simOnDisplayShow(const uint8_t *_data);
+
+class SimDisplay
+{
+private:
+  uint8_t data[4];
+
+public:
+  SimDisplay() { memset(data, 0, sizeof(data)); }
+
+  uint8_t encodeDigit(uint8_t _digit)
+  {
+    static const uint8_t seg[16] = {0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07,
+                                    0x7f, 0x6f, 0x77, 0x7c, 0x39, 0x5e, 0x79, 0x71};
+    return (seg[_digit & 0x0F]);
+  }
+
+  void setDispData(uint8_t _index, uint8_t _data)
+  {
+    if (_index < 4)
+    {
+      data[_index] = _data;
+    }
+  }
+
+  uint8_t getDispData(uint8_t _index) { return ((_index < 4) ? data[_index] : 0); }
+
+  void show() { simOnDisplayShow(data); }
+};
+
+extern SimDisplay clkDisplay;
+
+// ==== часы =========================================
+
+class shSimpleClock
+{
+private:
+  struct Task
+  {
+    uint32_t interval;
+    uint32_t timer;
+    void (*callback)();
+    bool active;
+  };
+
+  Task tasks[SIM_TASK_COUNT];
+  uint8_t task_count;
+  clkDisplayMode display_mode;
+  uint8_t button_state[3];
+  clkButtonFlag button_flag[3];
+
+public:
+  bool button_closed[3]; // нажатые в данный момент кнопки, задает тест
+  uint32_t rtc_reads;    // количество чтений RTC через getCurrentDateTime(), для симулятора
+
+  shSimpleClock() : task_count(0), display_mode(DISPLAY_MODE_SHOW_TIME), rtc_reads(0)
+  {
+    memset(button_state, 0, sizeof(button_state));
+    memset(button_flag, 0, sizeof(button_flag));
+    memset(button_closed, 0, sizeof(button_closed));
+  }
+
+  void setAdditionalTaskCount(uint8_t) {}
+
+  void init() {}
+
+  clkHandle addAdditionalTask(uint32_t _interval, void (*_callback)(), bool _active = true)
+  {
+    if (task_count >= SIM_TASK_COUNT)
+    {
+      return (-1);
+    }
+    tasks[task_count] = {_interval, millis(), _callback, _active};
+    return (task_count++);
+  }
+
+  void startTask(clkHandle _task)
+  {
+    tasks[_task].active = true;
+    tasks[_task].timer = millis();
+  }
+
+  void stopTask(clkHandle _task) { tasks[_task].active = false; }
+
+  bool getTaskState(clkHandle _task) { return (_task >= 0 && _task < task_count && tasks[_task].active); }
+
+  void setTaskInterval(clkHandle _task, uint32_t _interval, bool _restart = false)
+  {
+    tasks[_task].interval = _interval;
+    if (_restart)
+    {
+      startTask(_task);
+    }
+  }
+
+  void setTaskCallback(clkHandle _task, void (*_callback)()) { tasks[_task].callback = _callback; }
+
+  /**
+   * @brief время до ближайшего запуска задачи, мс; для симулятора
+   *
+   * @param _except битовая маска задач, которые не учитываются
+   */
+  uint32_t getTimeToNextTask(uint32_t _except = 0)
+  {
+    uint32_t x = 0xFFFFFFFF;
+    for (uint8_t i = 0; i < task_count; i++)
+    {
+      if (tasks[i].active && !(_except & (1ul << i)))
+      {
+        uint32_t t = millis() - tasks[i].timer;
+        t = (t < tasks[i].interval) ? tasks[i].interval - t : 0;
+        if (t < x)
+        {
+          x = t;
+        }
+      }
+    }
+    return (x);
+  }
+
+  void tick()
+  {
+    for (uint8_t i = 0; i < task_count; i++)
+    {
+      if (tasks[i].active && millis() - tasks[i].timer >= tasks[i].interval)
+      {
+        tasks[i].timer = millis();
+        tasks[i].callback();
+      }
+    }
+
+    // в своих режимах библиотека сама выводит на экран время
+    if (display_mode < DISPLAY_MODE_CUSTOM_1)
+    {
+      clkDateTime dt(simRtcMillis() / 1000);
+      clkDisplay.setDispData(0, clkDisplay.encodeDigit(dt.hour() / 10));
+      clkDisplay.setDispData(1, clkDisplay.encodeDigit(dt.hour() % 10) | 0x80);
+      clkDisplay.setDispData(2, clkDisplay.encodeDigit(dt.minute() / 10));
+      clkDisplay.setDispData(3, clkDisplay.encodeDigit(dt.minute() % 10));
+    }
+    clkDisplay.show();
+  }
+
+  clkDisplayMode getDisplayMode() { return (display_mode); }
+  void setDisplayMode(clkDisplayMode _mode) { display_mode = _mode; }
+
+  uint8_t getButtonState(clkButtonType _btn) { return (button_state[_btn]); }
+  void setButtonState(clkButtonType _btn, uint8_t _state) { button_state[_btn] = _state; }
+  void resetButtonState(clkButtonType _btn) { button_state[_btn] = BTN_RELEASED; }
+
+  clkButtonFlag getButtonFlag(clkButtonType _btn, bool _clear = false)
+  {
+    clkButtonFlag x = button_flag[_btn];
+    if (_clear)
+    {
+      button_flag[_btn] = CLK_BTN_FLAG_NONE;
+    }
+    return (x);
+  }
+  void setButtonFlag(clkButtonType _btn, clkButtonFlag _flag) { button_flag[_btn] = _flag; }
+
+  bool isButtonClosed(clkButtonType _btn) { return (button_closed[_btn]); }
+
+  /**
+   * @brief нет ни нажатых кнопок, ни необработанных кликов; для симулятора
+   */
+  bool isButtonIdle()
+  {
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      if (button_closed[i] || button_state[i] != BTN_RELEASED || button_flag[i] != CLK_BTN_FLAG_NONE)
+      {
+        return (false);
+      }
+    }
+    return (true);
+  }
+
+  bool getBlink() { return ((millis() / 500) % 2 == 0); }
+
+  clkDateTime getCurrentDateTime()
+  {
+    rtc_reads++;
+    return (clkDateTime(simRtcMillis() / 1000));
+  }
+
+  void setCurrentDateTime(clkDateTime _dt)
+  {
+    simSetRtcMillis(_dt.toSeconds() * 1000 + simRtcMillis() % 1000);
+  }
+};
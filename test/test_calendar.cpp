@@ -0,0 +1,171 @@
+/**
+ * @file test_calendar.cpp
+ *
+ * @brief Календарь исключений: проверка даты, отложенная запись при пакетном
+ *        изменении и поиск ближайшей точки после перестроения плана дня;
+ *        расписание по дням недели: смена набора промежутков в полночь;
+ *        год работы високосного года с отмеченными датами
+ *
+ */
+#include "sim.h"
+
+static void testHolidays()
+{
+  // даты за пределами года не принимаются и не портят соседние настройки
+  uint8_t days = sim_eeprom[ALARM_DAYS_EEPROM_INDEX];
+  SIM_CHECK(!saAlarm.setHoliday(ALARM_DATE_COUNT, true));
+  SIM_CHECK(!saAlarm.setHoliday(0xFFFF, true));
+  simFlushEeprom();
+  SIM_CHECK_EQ(sim_eeprom[ALARM_DAYS_EEPROM_INDEX], days);
+  SIM_CHECK(!saAlarm.isHoliday(ALARM_DATE_COUNT));
+
+  // сегодня (1 января) - исключение: точек до конца суток нет
+  SIM_CHECK_EQ(saAlarm.getNextPoint(), 8 * 60);
+  uint32_t writes = sim_eeprom_writes;
+  saAlarm.beginUpdate();
+  SIM_CHECK(saAlarm.setHoliday(0, true));
+  SIM_CHECK(saAlarm.setHoliday(ALARM_DATE_COUNT - 1, true));
+  SIM_CHECK_EQ(saAlarm.getNextPoint(), 8 * 60);
+  simFlushEeprom();
+  SIM_CHECK_EQ(sim_eeprom_writes, writes);
+  saAlarm.endUpdate();
+  SIM_CHECK_EQ(saAlarm.getNextPoint(), ALARM_NO_POINT);
+  simFlushEeprom();
+  SIM_CHECK_EQ(sim_eeprom[ALARM_HOLIDAYS_EEPROM_INDEX], 0xFE);
+  SIM_CHECK_EQ(sim_eeprom[ALARM_HOLIDAYS_EEPROM_INDEX + ALARM_HOLIDAYS_SIZE - 1], 0xDF);
+
+  sim_events.clear();
+  simRunUntil(simRtcMillis() + 2 * 3600000ull);
+  SIM_CHECK_EQ(simAlarms().size(), 0);
+
+  // снятие отметки возвращает точки, которые еще впереди
+  saAlarm.setHoliday(0, false);
+  SIM_CHECK_EQ(saAlarm.getNextPoint(), 9 * 60 + 30);
+  simRunUntil(simRtcMillis() + 3600000ull);
+  SIM_CHECK_EQ(simAlarms().size(), 1);
+
+  // календарь переживает перезагрузку, очистка возвращает чистую EEPROM
+  saAlarm.begin();
+  SIM_CHECK(!saAlarm.isHoliday(0));
+  SIM_CHECK(saAlarm.isHoliday(ALARM_DATE_COUNT - 1));
+  saAlarm.clearHolidays();
+  simFlushEeprom();
+  for (uint8_t i = 0; i < ALARM_HOLIDAYS_SIZE; i++)
+  {
+    SIM_CHECK_EQ(sim_eeprom[ALARM_HOLIDAYS_EEPROM_INDEX + i], 0xFF);
+  }
+}
+
+static void testDays()
+{
+  // четверг - только первый промежуток, пятница - только второй
+  saAlarm.beginUpdate();
+  saAlarm.setAlarmPoint1(6 * 60, 1);
+  saAlarm.setAlarmPoint2(7 * 60, 1);
+  saAlarm.setAlarmInterval(30, 1);
+  saAlarm.setOnOffWindow(1, true);
+  saAlarm.setDayWindows(4, 0x01);
+  saAlarm.setDayWindows(5, 0x02);
+  saAlarm.endUpdate();
+
+  // до конца четверга точек нет, ближайшая - первая точка плана четверга
+  SIM_CHECK(simRtcTime() > 9 * 3600 + 30 * 60);
+  SIM_CHECK_EQ(saAlarm.getNextPoint(), 8 * 60);
+
+  // в полночь план перестраивается по расписанию пятницы
+  simRunUntil(86400000ull + 5000);
+  SIM_CHECK_EQ(saAlarm.getNextPoint(), 6 * 60);
+
+  sim_events.clear();
+  simRunUntil(86400000ull + 12 * 3600000ull);
+  std::vector<SimEvent> alarms = simAlarms();
+  SIM_CHECK_EQ(alarms.size(), 2);
+  if (alarms.size() == 2)
+  {
+    SIM_CHECK_EQ(simEventTime(alarms[0]), 6 * 3600);
+    SIM_CHECK_EQ(simEventTime(alarms[1]), 6 * 3600 + 30 * 60);
+  }
+  SIM_CHECK_EQ(saAlarm.getNextPoint(), 6 * 60);
+}
+
+static void testYear()
+{
+  // 29 февраля, 1 марта невисокосного года, 31 декабря и несколько дат
+  // внутри года; 1 марта не отмечается - номер даты следует за 29 февраля
+  static const uint8_t marked[][2] = {{1, 1}, {2, 29}, {5, 9}, {7, 14}, {11, 30}, {12, 31}};
+  saAlarm.beginUpdate();
+  saAlarm.setOnOffWindow(1, false);
+  for (uint8_t i = 0; i < ALARM_DAY_COUNT; i++)
+  {
+    saAlarm.setDayWindows(i, ALARM_ALL_WINDOWS);
+  }
+  saAlarm.clearHolidays();
+  for (uint8_t i = 0; i < sizeof(marked) / sizeof(marked[0]); i++)
+  {
+    SIM_CHECK(saAlarm.setHoliday(getDateIndex(marked[i][0], marked[i][1]), true));
+  }
+  saAlarm.endUpdate();
+
+  // весь 2028 год, сутки за сутками
+  sim_skip_display = true;
+  simSetDateTime(2027, 12, 31, 23, 0, 0);
+  simApplyTime();
+  simRunUntil(clkDateTime(2028, 1, 1, 0, 0, 0).toSeconds() * 1000);
+  uint16_t days = 0;
+  uint16_t holidays = 0;
+  while (true)
+  {
+    clkDateTime dt(simRtcMillis() / 1000);
+    if (dt.year() != 2028)
+    {
+      break;
+    }
+    bool holiday = false;
+    for (uint8_t i = 0; i < sizeof(marked) / sizeof(marked[0]); i++)
+    {
+      holiday = holiday || (dt.month() == marked[i][0] && dt.day() == marked[i][1]);
+    }
+
+    sim_events.clear();
+    simRunUntil((simRtcMillis() / 86400000ull + 1) * 86400000ull);
+    std::vector<SimEvent> alarms = simAlarms();
+    if (holiday)
+    {
+      SIM_CHECK_EQ(alarms.size(), 0);
+      holidays++;
+    }
+    else
+    {
+      SIM_CHECK_EQ(alarms.size(), 2);
+      if (alarms.size() == 2)
+      {
+        SIM_CHECK_EQ(simEventTime(alarms[0]), 8 * 3600);
+        SIM_CHECK_EQ(simEventTime(alarms[1]), 9 * 3600 + 30 * 60);
+      }
+    }
+    days++;
+  }
+  sim_skip_display = false;
+  SIM_CHECK_EQ(days, 366);
+  SIM_CHECK_EQ(holidays, sizeof(marked) / sizeof(marked[0]));
+}
+
+int main()
+{
+  // четверг, 1 января 2026 г., 07:00
+  simSetDateTime(2026, 1, 1, 7, 0, 0);
+  simBoot();
+  saAlarm.beginUpdate();
+  saAlarm.setOnOffAlarm(true);
+  saAlarm.setAlarmPoint1(8 * 60);
+  saAlarm.setAlarmPoint2(11 * 60);
+  saAlarm.setAlarmInterval(90);
+  saAlarm.endUpdate();
+  applyAlarmSettings();
+
+  testHolidays();
+  testDays();
+  testYear();
+
+  return (simResult("test_calendar"));
+}
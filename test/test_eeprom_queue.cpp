@@ -0,0 +1,117 @@
+/**
+ * @file test_eeprom_queue.cpp
+ *
+ * @brief Очередь записи в EEPROM: сравнение со словарем ячеек на случайных
+ *        записях и чтениях, размещение блоков без записи с ожиданием,
+ *        отложенная запись блоков настроек будильника
+ *
+ */
+#include "sim.h"
+#include <map>
+#include <random>
+
+static void testRandom()
+{
+  std::mt19937 rnd(1);
+  std::map<uint16_t, uint8_t> model;
+  for (uint16_t i = 0; i < SIM_EEPROM_SIZE; i++)
+  {
+    model[i] = sim_eeprom[i];
+  }
+
+  for (int n = 0; n < 200000; n++)
+  {
+    uint32_t op = rnd() % 10;
+    if (op < 6)
+    { // запись, чаще всего - подряд идущих ячеек
+      static uint16_t index = 0;
+      index = (op < 4) ? (index + 1) % 64 : rnd() % 64;
+      uint8_t data = rnd();
+      saEepromQueue.write(500 + index, data);
+      model[500 + index] = data;
+    }
+    else if (op < 9)
+    {
+      uint16_t index = 500 + rnd() % 64;
+      SIM_CHECK_EQ(saEepromQueue.read(index), model[index]);
+    }
+    else
+    {
+      saEepromQueue.tick();
+    }
+  }
+
+  saEepromQueue.flush();
+  SIM_CHECK(saEepromQueue.isEmpty());
+  for (uint16_t i = 0; i < SIM_EEPROM_SIZE; i++)
+  {
+    SIM_CHECK_EQ(sim_eeprom[i], model[i]);
+  }
+}
+
+static void testBlocks()
+{
+  // самый большой блок списка точек помещается в пустую очередь целиком
+  SIM_CHECK(saEepromQueue.hasRoom(ALARM_LIST_BLOCK_SIZE));
+  uint32_t writes = sim_eeprom_writes;
+  for (uint8_t i = 0; i < ALARM_LIST_BLOCK_SIZE; i++)
+  {
+    saEepromQueue.write(600 + i, i);
+  }
+  SIM_CHECK_EQ(sim_eeprom_writes, writes);
+  SIM_CHECK(!saEepromQueue.hasRoom(ALARM_LIST_BLOCK_SIZE));
+
+  // по мере записи место освобождается
+  while (!saEepromQueue.hasRoom(ALARM_LIST_BLOCK_SIZE))
+  {
+    saEepromQueue.tick();
+  }
+  SIM_CHECK(sim_eeprom_writes > writes);
+  saEepromQueue.flush();
+  for (uint8_t i = 0; i < ALARM_LIST_BLOCK_SIZE; i++)
+  {
+    SIM_CHECK_EQ(sim_eeprom[600 + i], i);
+  }
+}
+
+static void testAlarmBatch()
+{
+  // журнал, полный список точек и дни недели одним пакетом не помещаются в
+  // очередь, но ни один байт не пишется с ожиданием - блоки, которым не
+  // хватило места, ставятся в очередь из loop() по мере ее освобождения
+  uint16_t list[ALARM_LIST_SIZE];
+  for (uint8_t i = 0; i < ALARM_LIST_SIZE; i++)
+  {
+    list[i] = i * 40;
+  }
+  uint32_t writes = sim_eeprom_writes;
+  saAlarm.beginUpdate();
+  saAlarm.setAlarmInterval(40);
+  saAlarm.setPointList(list, ALARM_LIST_SIZE);
+  saAlarm.setDayWindows(0, 0);
+  saAlarm.endUpdate();
+  saAlarm.setAlarmInterval(50);
+  SIM_CHECK_EQ(sim_eeprom_writes, writes);
+  SIM_CHECK(saAlarm.isWritePending());
+
+  simRun(1000);
+  SIM_CHECK(!saAlarm.isWritePending());
+  SIM_CHECK(saEepromQueue.isEmpty());
+  saAlarm.begin();
+  SIM_CHECK_EQ(saAlarm.getAlarmInterval(), 50);
+  SIM_CHECK_EQ(saAlarm.getListCount(), ALARM_LIST_SIZE);
+  SIM_CHECK_EQ(saAlarm.getListPoint(ALARM_LIST_SIZE - 1), (ALARM_LIST_SIZE - 1) * 40);
+  SIM_CHECK_EQ(saAlarm.getDayWindows(0), 0);
+}
+
+int main()
+{
+  simBoot();
+  saEepromQueue.flush();
+
+  testRandom();
+  testBlocks();
+  testAlarmBatch();
+
+  return (simResult("test_eeprom_queue"));
+}
@@ -0,0 +1,47 @@
+/**
+ * @file test_journal.cpp
+ *
+ * @brief Перенос настроек из журнала версии 1 (без мелодии и
+ *        продолжительности сигнала) в журнал версии 2
+ *
+ */
+#include "sim.h"
+
+int main()
+{
+  // журнал прежней версии прошивки: три записи, действует последняя
+  EepromJournal v1(ALARM_JOURNAL_EEPROM_INDEX, ALARM_JOURNAL_SLOT_COUNT, ALARM_SETTINGS_V1_SIZE, 1);
+  uint8_t x[ALARM_SETTINGS_V1_SIZE];
+  memset(x, 0, sizeof(x));
+  x[0] = 1;                 // on_off
+  x[1] = ALARM_MODE_INTERVAL;
+  x[2] = 0x03;              // промежутки 1 и 2
+  for (uint16_t n = 0; n < 3; n++)
+  {
+    uint16_t w[6] = {(uint16_t)(480 + n), 540, 20, 1200, 1260, 15};
+    memcpy(&x[3], w, sizeof(w));
+    v1.save(x);
+  }
+  simFlushEeprom();
+
+  simSetDateTime(2026, 1, 1, 7, 0, 0);
+  simBoot();
+  SIM_CHECK_EQ(saAlarm.getOnOffAlarm(), true);
+  SIM_CHECK_EQ(saAlarm.getAlarmPoint1(0), 482);
+  SIM_CHECK_EQ(saAlarm.getAlarmInterval(0), 20);
+  SIM_CHECK_EQ(saAlarm.getAlarmPoint2(1), 1260);
+  SIM_CHECK_EQ(saAlarm.getAlarmInterval(1), 15);
+  SIM_CHECK_EQ(saAlarm.getAlarmMelody(), 0);
+  SIM_CHECK_EQ(saAlarm.getAlarmDuration(), ALARM_DURATION);
+
+  // перенесенные настройки сохранены записью версии 2 и читаются уже из нее
+  simFlushEeprom();
+  SIM_CHECK_EQ(sim_eeprom[ALARM_JOURNAL_EEPROM_INDEX], ALARM_SETTINGS_VERSION);
+  saAlarm.setAlarmDuration(7);
+  simFlushEeprom();
+  saAlarm.begin();
+  SIM_CHECK_EQ(saAlarm.getAlarmPoint1(0), 482);
+  SIM_CHECK_EQ(saAlarm.getAlarmDuration(), 7);
+
+  return (simResult("test_journal"));
+}
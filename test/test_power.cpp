@@ -0,0 +1,83 @@
+/**
+ * @file test_power.cpp
+ *
+ * @brief Сон между событиями будильника (собирается с USE_POWER_SAVE):
+ *        засыпание в режиме показа времени, сутки со сном между точками
+ *        срабатывания и пробуждением по будильнику RTC, доля времени
+ *        бодрствования и вывод статистики сна по команде 'w'
+ *
+ */
+#include "sim.h"
+
+#define POWER_POINTS 12     // точек срабатывания за сутки, 08:00..19:00
+#define POWER_EDGES 2       // смен цвета светодиода за сутки, 08:00 и 20:00
+#define POWER_WAKE_SLACK 5ul // запас на пробуждение и засыпание, секунд
+
+// значение из статистики сна, выведенной по команде 'w'
+static uint32_t dumpValue(const std::string &_dump, const char *_name)
+{
+  std::string key = std::string(_name) + ";";
+  size_t i = _dump.find(key);
+  SIM_CHECK(i != std::string::npos);
+  return ((i != std::string::npos) ? strtoul(_dump.c_str() + i + key.size(), NULL, 10) : 0);
+}
+
+static void testDay()
+{
+  saAlarm.beginUpdate();
+  saAlarm.setOnOffAlarm(true);
+  saAlarm.setAlarmPoint1(8 * 60);
+  saAlarm.setAlarmPoint2(20 * 60);
+  saAlarm.setAlarmInterval(60);
+  saAlarm.endUpdate();
+  applyAlarmSettings();
+
+  // сутки от полуночи до полуночи
+  simRunUntil((simRtcMillis() / 86400000ull + 1) * 86400000ull);
+  std::string before = simSerial("w\n");
+  uint64_t start = simRtcMillis();
+  sim_events.clear();
+  simRunUntil(start + 86400000ull);
+  std::string after = simSerial("w\n");
+
+  // каждая точка срабатывает в свою секунду, хотя между точками
+  // контроллер спит, а millis() стоит
+  std::vector<SimEvent> alarms = simAlarms();
+  SIM_CHECK_EQ(alarms.size(), POWER_POINTS);
+  for (size_t i = 0; i < alarms.size(); i++)
+  {
+    SIM_CHECK_EQ(simEventTime(alarms[i]), 8 * 3600ul + i * 3600ul);
+    SIM_CHECK(alarms[i].rtc % 1000 < ALARM_GUARD_FINE_INTERVAL + 10);
+  }
+
+  // между событиями контроллер спит: бодрствует только пока звучит сигнал,
+  // POWER_SAVE_IDLE_TIME перед каждым засыпанием и запас на пробуждение
+  uint32_t sleeps = dumpValue(after, "sleeps") - dumpValue(before, "sleeps");
+  uint32_t awake = dumpValue(after, "awake_ms") - dumpValue(before, "awake_ms");
+  uint32_t bound = POWER_POINTS * (ALARM_DURATION * 1000ul) +
+                   (POWER_POINTS + POWER_EDGES + 1) * (POWER_SAVE_IDLE_TIME + POWER_WAKE_SLACK * 1000ul);
+  SIM_CHECK(sleeps >= POWER_POINTS + POWER_EDGES);
+  SIM_CHECK(awake <= bound);
+
+  // доля бодрствования с момента включения (до этих суток часы в основном
+  // спали) - не больше той же границы, отнесенной к суткам
+  SIM_CHECK(dumpValue(after, "duty_permille") <= bound / 86400ul + 1);
+}
+
+int main()
+{
+  simSetDateTime(2026, 1, 1, 7, 0, 0);
+  simBoot();
+
+  // без событий будильника часы засыпают до полуночи
+  simRunUntil(simRtcMillis() + 60000ull);
+  SIM_CHECK(saTime.getDayOfWeek() == 5);
+
+  std::string x = simSerial("w\n");
+  SIM_CHECK_EQ(x.compare(0, 7, "sleeps;"), 0);
+  SIM_CHECK(x.find("OK") == std::string::npos);
+
+  testDay();
+
+  return (simResult("test_power"));
+}
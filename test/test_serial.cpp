@@ -0,0 +1,108 @@
+/**
+ * @file test_serial.cpp
+ *
+ * @brief Команды настройки через Serial
+ *
+ */
+#include "sim.h"
+
+static void testPointList()
+{
+  SIM_CHECK_STR(simSerial("L 100 200 300\n"), "OK\r\n");
+  SIM_CHECK_EQ(saAlarm.getListCount(), 3);
+
+  // строка с ошибкой не меняет список ни в памяти, ни в EEPROM
+  SIM_CHECK_STR(simSerial("L 500 9999\n"), "ERR\r\n");
+  SIM_CHECK_STR(simSerial("P 400 2000\n"), "ERR\r\n");
+  SIM_CHECK_EQ(saAlarm.getListCount(), 3);
+  SIM_CHECK_EQ(saAlarm.getListPoint(0), 100);
+
+  // повторы отбрасываются, новые точки встают на свои места
+  SIM_CHECK_STR(simSerial("P 50 200 250 50\n"), "OK\r\n");
+  SIM_CHECK_EQ(saAlarm.getListCount(), 5);
+  SIM_CHECK_EQ(saAlarm.getListPoint(0), 50);
+  SIM_CHECK_EQ(saAlarm.getListPoint(2), 200);
+  SIM_CHECK_EQ(saAlarm.getListPoint(3), 250);
+
+  // переполнение списка - ошибка, список не меняется
+  std::string line = "L";
+  for (int i = 0; i <= ALARM_LIST_SIZE; i++)
+  {
+    line += " " + std::to_string(i * 10);
+  }
+  SIM_CHECK_STR(simSerial((line + "\n").c_str()), "ERR\r\n");
+  SIM_CHECK_EQ(saAlarm.getListCount(), 5);
+
+  simFlushEeprom();
+  saAlarm.begin();
+  SIM_CHECK_EQ(saAlarm.getListCount(), 5);
+  SIM_CHECK_EQ(saAlarm.getListPoint(4), 300);
+
+  SIM_CHECK_STR(simSerial("L\n"), "OK\r\n");
+  SIM_CHECK_EQ(saAlarm.getListCount(), 0);
+}
+
+static void testStrayLine()
+{
+  // оборванная строка не открывает пакетное изменение и отбрасывается
+  // по таймауту
+  SIM_CHECK_STR(simSerial("A"), "");
+  simRun(60000);
+  uint32_t writes = sim_eeprom_writes;
+  saAlarm.setAlarmPoint1(600);
+  simFlushEeprom();
+  SIM_CHECK(sim_eeprom_writes > writes);
+  SIM_CHECK_STR(simSerial(" 1\n"), "ERR\r\n");
+
+  // незакрытый пакет применяется по таймауту
+  SIM_CHECK_STR(simSerial("B\nW 0 1 480 540 20\n"), "OK\r\nOK\r\n");
+  SIM_CHECK_EQ(saAlarm.getAlarmInterval(0), 20);
+  writes = sim_eeprom_writes;
+  simRun(SERIAL_COMMANDS_TIMEOUT + 100);
+  simFlushEeprom();
+  SIM_CHECK(sim_eeprom_writes > writes);
+  saAlarm.begin();
+  SIM_CHECK_EQ(saAlarm.getAlarmPoint1(0), 480);
+  SIM_CHECK_EQ(saAlarm.getAlarmInterval(0), 20);
+}
+
+static void testLastWindow()
+{
+  // последний включенный промежуток не выключается, строка не применяется
+  SIM_CHECK_STR(simSerial("W 1 0 600 660 30\n"), "OK\r\n");
+  SIM_CHECK_STR(simSerial("W 2 0 600 660 30\n"), "OK\r\n");
+  SIM_CHECK_STR(simSerial("W 0 1 480 540 20\n"), "OK\r\n");
+  SIM_CHECK_STR(simSerial("W 0 0 500 560 25\n"), "ERR\r\n");
+  SIM_CHECK(saAlarm.getOnOffWindow(0));
+  SIM_CHECK_EQ(saAlarm.getAlarmPoint1(0), 480);
+  SIM_CHECK_EQ(saAlarm.getAlarmInterval(0), 20);
+  SIM_CHECK(!saAlarm.setOnOffWindow(0, false));
+  SIM_CHECK(saAlarm.setOnOffWindow(0, true));
+}
+
+static void testDumpReplay()
+{
+  // вывод настроек принимается обратно без ошибок, даже если в нем
+  // выключен единственный сейчас включенный промежуток
+  SIM_CHECK_STR(simSerial("B\nW 1 1 600 660 30\nW 0 0 480 540 20\nE\n"), "OK\r\nOK\r\nOK\r\nOK\r\n");
+  std::string dump = simSerial("?\n");
+  dump.resize(dump.size() - 4); // ответ "OK" на саму команду
+  SIM_CHECK_STR(simSerial("B\nW 0 1 480 540 20\nW 1 0 600 660 30\nE\n"), "OK\r\nOK\r\nOK\r\nOK\r\n");
+  std::string x = simSerial(dump.c_str());
+  SIM_CHECK(x.find("ERR") == std::string::npos);
+  SIM_CHECK(!saAlarm.getOnOffWindow(0));
+  SIM_CHECK(saAlarm.getOnOffWindow(1));
+}
+
+int main()
+{
+  simSetDateTime(2026, 1, 1, 7, 0, 0);
+  simBoot();
+
+  testPointList();
+  testStrayLine();
+  testLastWindow();
+  testDumpReplay();
+
+  return (simResult("test_serial"));
+}
@@ -0,0 +1,62 @@
+/**
+ * @file test_sim.cpp
+ *
+ * @brief Сутки работы будильника в симуляторе: запуски сигнала, светодиоды,
+ *        кадры экрана и запись настроек в EEPROM
+ *
+ */
+#include "sim.h"
+
+int main()
+{
+  // четверг, 1 января 2026 г., 07:00
+  simSetDateTime(2026, 1, 1, 7, 0, 0);
+  simBoot();
+  SIM_CHECK_EQ(saTime.getTime(), 7 * 3600ul);
+  SIM_CHECK_EQ(saTime.getDayOfWeek(), 4);
+
+  saAlarm.beginUpdate();
+  saAlarm.setOnOffAlarm(true);
+  saAlarm.setAlarmPoint1(8 * 60);
+  saAlarm.setAlarmPoint2(9 * 60);
+  saAlarm.setAlarmInterval(30);
+  saAlarm.setAlarmDuration(5);
+  saAlarm.endUpdate();
+  applyAlarmSettings();
+  simRun(1000);
+  SIM_CHECK(saEepromQueue.isEmpty());
+
+  sim_events.clear();
+  uint64_t start = simRtcMillis();
+  simRunUntil(start + 86400000ull);
+
+  // сигнал в 08:00 и 08:30 (окончание промежутка в точки не входит) и
+  // каждый раз звучит 5 секунд
+  std::vector<SimEvent> alarms = simAlarms();
+  SIM_CHECK_EQ(alarms.size(), 2);
+  for (size_t i = 0; i < alarms.size() && i < 2; i++)
+  {
+    SIM_CHECK_EQ(simEventTime(alarms[i]), 8 * 3600ul + i * 1800ul);
+  }
+  SIM_CHECK_EQ(simCount(SIM_EVENT_BUZZER, 0), 2);
+  SIM_CHECK(simCount(SIM_EVENT_TONE, 0) >= 2);
+
+  // зеленый светодиод мигает во время сигнала, красный гаснет на время
+  // промежутка
+  SIM_CHECK(simCount(SIM_EVENT_LED, ALARM_GREEN_PIN * 256u + HIGH) >= 2);
+  SIM_CHECK_EQ(simCount(SIM_EVENT_LED, ALARM_RED_PIN * 256u + LOW), 1);
+  SIM_CHECK_EQ(simCount(SIM_EVENT_LED, ALARM_RED_PIN * 256u + HIGH), 1);
+
+  // библиотека показывает время - кадр меняется раз в минуту
+  uint32_t frames = 0;
+  for (size_t i = 0; i < sim_events.size(); i++)
+  {
+    frames += (sim_events[i].type == SIM_EVENT_FRAME);
+  }
+  SIM_CHECK_EQ(frames, 1440);
+
+  // в полночь наступила пятница
+  SIM_CHECK_EQ(saTime.getDayOfWeek(), 5);
+
+  return (simResult("test_sim"));
+}
@@ -0,0 +1,94 @@
+/**
+ * @file test_time.cpp
+ *
+ * @brief Источник времени: поиск начала секунды RTC и срабатывание
+ *        будильника без опоздания на долю секунды при расхождении millis()
+ *        и RTC
+ *
+ */
+#include "sim.h"
+
+// ошибка точки отсчета - промежуток между чтениями RTC
+static void testLock()
+{
+  SIM_CHECK(!saTime.isLocked());
+  SIM_CHECK_EQ(saTime.getFraction(), 0);
+
+  for (int i = 0; i < 15; i++)
+  {
+    sim_now_us += 100000;
+    saTime.getTime();
+  }
+  SIM_CHECK(saTime.isLocked());
+  SIM_CHECK_EQ(saTime.getTime(), simRtcTime());
+  int32_t x = (int32_t)(simRtcMillis() % 1000) - saTime.getFraction();
+  SIM_CHECK(x >= 0 && x <= 100);
+
+  // до следующей сверки RTC не читается, начало секунды после сверки
+  // ищется заново, а найденное раньше остается в силе; на каждую сверку
+  // приходится само чтение и не больше секунды поиска
+  uint32_t reads = saClock.rtc_reads;
+  uint32_t unlocked = 0;
+  for (uint32_t i = 0; i < 3 * TIME_SYNC_INTERVAL / 10; i++)
+  {
+    sim_now_us += 10000;
+    // время по millis() отстает от RTC не больше, чем на ошибку точки отсчета
+    int32_t lag = (int32_t)simRtcTime() - (int32_t)saTime.getTime();
+    SIM_CHECK(lag == 0 || (lag == 1 && simRtcMillis() % 1000 < 100));
+    unlocked += !saTime.isLocked();
+  }
+  SIM_CHECK_EQ(unlocked, 0);
+  SIM_CHECK(saClock.rtc_reads - reads <= 3 * (2 + 1000 / TIME_LOCK_POLL));
+  int32_t y = (int32_t)(simRtcMillis() % 1000) - saTime.getFraction();
+  SIM_CHECK(y >= 0 && y <= (int32_t)TIME_LOCK_POLL);
+
+  // после изменения времени пользователем начало секунды ищется заново
+  saTime.sync();
+  saTime.getTime();
+  SIM_CHECK(!saTime.isLocked());
+}
+
+// сигнал запускается в первые доли секунды точки срабатывания, хотя часы
+// включены в конце секунды, а millis() отстает от RTC
+static void testTrigger()
+{
+  simSetDateTime(2026, 1, 1, 7, 0, 0, 900);
+  simSetRtcDrift(300);
+  simApplyTime();
+  saAlarm.beginUpdate();
+  saAlarm.setOnOffAlarm(true);
+  saAlarm.setAlarmPoint1(8 * 60);
+  saAlarm.setAlarmPoint2(9 * 60);
+  saAlarm.setAlarmInterval(20);
+  saAlarm.endUpdate();
+  applyAlarmSettings();
+
+  sim_events.clear();
+  simRunUntil(simRtcMillis() + 3 * 3600000ull);
+  std::vector<SimEvent> alarms = simAlarms();
+  SIM_CHECK_EQ(alarms.size(), 3);
+  int32_t late = 0;
+  for (size_t i = 0; i < alarms.size(); i++)
+  {
+    SIM_CHECK_EQ(simEventTime(alarms[i]), 8 * 3600ul + i * 1200ul);
+    SIM_CHECK(alarms[i].rtc % 1000 < TIME_LOCK_WINDOW + ALARM_GUARD_FINE_INTERVAL);
+    late = std::max(late, (int32_t)(alarms[i].rtc % 1000));
+  }
+
+  // статистика не завышает задержку и занижает ее не больше, чем на
+  // ошибку точки отсчета
+  SIM_CHECK_EQ(saTriggerStats.getCount(), 3);
+  int32_t x = late - saTriggerStats.getMaxDelay();
+  SIM_CHECK(x >= 0 && x <= (int32_t)TIME_LOCK_WINDOW);
+}
+
+int main()
+{
+  simSetDateTime(2026, 1, 1, 7, 0, 0, 370);
+  simBoot();
+
+  testLock();
+  testTrigger();
+
+  return (simResult("test_time"));
+}
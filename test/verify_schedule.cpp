@@ -0,0 +1,429 @@
+/**
+ * @file verify_schedule.cpp
+ *
+ * @brief Проверка плана дня будильника перебором: карта точек
+ *        (checkPoint()), количество точек, поиск ближайшей точки
+ *        (seekPoint(), nextPoint(), prevPoint()), попадание в промежуток
+ *        (checkForInterval()) и срабатывание в tick() сравниваются с простой
+ *        моделью "какие минуты срабатывают", построенной проходом по минутам
+ *        промежутка;
+ *
+ *        без параметров проверяется выборка: один промежуток для 10 значений
+ *        начала, всех значений окончания и всех шагов интервала (seekPoint()
+ *        при этом проверяется в каждой 17-й минуте, в точках и сразу после
+ *        них), а также
+ *        случайные наборы из нескольких промежутков и списки точек с
+ *        проверкой tick() на сутках со случайными промежутками между
+ *        проверками; с параметром full - один промежуток для всех
+ *        1440 x 1440 x 18 сочетаний;
+ *
+ *        будильник работает с глобальными объектами скетча (очередь записи
+ *        в EEPROM), поэтому работа делится не между потоками, а между
+ *        процессами по числу ядер; задания раздаются через общий счетчик, и
+ *        освободившийся процесс сразу берет следующее
+ *
+ */
+#include "sim.h"
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DAY_MINUTES (MAX_DATA + 1)
+#define INTERVAL_STEPS ((MAX_INTERVAL - MIN_INTERVAL) / 10 + 1)
+#define SAMPLE_STARTS 10
+#define SAMPLE_SEEK_STEP 17
+#define RANDOM_CONFIGS 4000
+#define MAX_REPORTS 10
+
+struct Shared // общие для всех процессов счетчики
+{
+  std::atomic<uint32_t> next;       // следующее задание
+  std::atomic<uint64_t> configs;    // проверено наборов настроек
+  std::atomic<uint64_t> mismatches; // найдено расхождений
+};
+
+static Shared *shared;
+
+struct Reference // модель: какие минуты срабатывают и какие входят в промежутки
+{
+  bool fire[DAY_MINUTES];
+  bool inside[DAY_MINUTES];
+  uint16_t count;
+  int16_t next[DAY_MINUTES];       // ближайшая точка от минуты вперед по кругу, -1 - точек нет
+  uint16_t left[DAY_MINUTES];      // для точки - количество точек от нее до конца суток
+  uint16_t before[DAY_MINUTES + 1]; // количество точек раньше минуты
+};
+
+static void addWindow(Reference &_ref, uint16_t _p1, uint16_t _p2, uint16_t _interval)
+{
+  if (_p1 == _p2)
+  { // однократное срабатывание, промежутка для светодиода нет
+    _ref.fire[_p1] = true;
+    return;
+  }
+  // проход по минутам промежутка от начала до окончания (не включая его),
+  // срабатывает каждая _interval-ная минута
+  for (uint16_t m = _p1, k = 0; m != _p2; m = (m + 1) % DAY_MINUTES, k++)
+  {
+    _ref.inside[m] = true;
+    if (k % _interval == 0)
+    {
+      _ref.fire[m] = true;
+    }
+  }
+}
+
+static void countPoints(Reference &_ref)
+{
+  _ref.before[0] = 0;
+  for (uint16_t m = 0; m < DAY_MINUTES; m++)
+  {
+    _ref.before[m + 1] = _ref.before[m] + _ref.fire[m];
+  }
+  _ref.count = _ref.before[DAY_MINUTES];
+
+  int16_t x = -1;
+  for (int16_t i = 2 * DAY_MINUTES - 1; i >= 0; i--)
+  {
+    uint16_t m = i % DAY_MINUTES;
+    x = (_ref.fire[m]) ? m : x;
+    if (i < DAY_MINUTES)
+    {
+      _ref.next[m] = x;
+      _ref.left[m] = _ref.count - _ref.before[m];
+    }
+  }
+}
+
+static bool report(const char *_what, const char *_config, long _at, long _got, long _expected)
+{
+  uint64_t n = shared->mismatches++;
+  if (n < MAX_REPORTS)
+  {
+    printf("mismatch: %s at %ld: got %ld, expected %ld; %s\n", _what, _at, _got, _expected, _config);
+  }
+  return (false);
+}
+
+// сравнение плана дня, построенного будильником, с моделью; seekPoint()
+// проверяется в каждой _seek_step минуте, а также в точках и сразу после них
+static bool checkSchedule(const Reference &_ref, const char *_config, uint16_t _seek_step)
+{
+  if (saAlarm.getPointCount() != _ref.count)
+  {
+    return (report("getPointCount", _config, 0, saAlarm.getPointCount(), _ref.count));
+  }
+
+  const int16_t *next = _ref.next;
+  const uint16_t *left = _ref.left;
+  for (uint16_t m = 0; m < DAY_MINUTES; m++)
+  {
+    if (saAlarm.checkPoint(m) != _ref.fire[m])
+    {
+      return (report("checkPoint", _config, m, saAlarm.checkPoint(m), _ref.fire[m]));
+    }
+    uint16_t t = m;
+    if (saAlarm.checkForInterval(t) != _ref.inside[m])
+    {
+      return (report("checkForInterval", _config, m, !_ref.inside[m], _ref.inside[m]));
+    }
+
+    if (m % _seek_step && !_ref.fire[m] && !_ref.fire[(m + DAY_MINUTES - 1) % DAY_MINUTES])
+    {
+      continue;
+    }
+
+    // результат seekPoint() для секунд от начала минуты m (не включая его)
+    // до начала следующей одинаков и отличается от результата для начала
+    // минуты, только если m - точка; поэтому проверяются начало каждой
+    // минуты и следующая за ним секунда, если минута - точка
+    for (uint32_t s = m * 60ul; s <= m * 60ul + _ref.fire[m]; s++)
+    {
+      uint16_t e = (s == m * 60ul) ? m : (m + 1) % DAY_MINUTES;
+      AlarmCursor c = saAlarm.seekPoint(s);
+      uint16_t p = (next[e] < 0) ? ALARM_NO_POINT : next[e];
+      if (c.point != p)
+      {
+        return (report("seekPoint", _config, s, c.point, p));
+      }
+      if (p != ALARM_NO_POINT && c.left != left[p])
+      {
+        return (report("seekPoint left", _config, s, c.left, left[p]));
+      }
+    }
+  }
+
+  // обход точек вперед и назад по кругу
+  if (_ref.count)
+  {
+    AlarmCursor c = saAlarm.seekPoint(0);
+    AlarmCursor b = c;
+    for (uint16_t i = 1; i <= _ref.count; i++)
+    {
+      bool wrap = !saAlarm.nextPoint(c);
+      uint16_t p = next[(b.point + 1) % DAY_MINUTES];
+      if (c.point != p || wrap != (i == _ref.count) || c.left != left[p])
+      {
+        return (report("nextPoint", _config, b.point, c.point, p));
+      }
+      AlarmCursor d = c;
+      saAlarm.prevPoint(d);
+      if (d.point != b.point || d.left != b.left)
+      {
+        return (report("prevPoint", _config, c.point, d.point, b.point));
+      }
+      b = c;
+    }
+  }
+
+  return (true);
+}
+
+// сутки проверок tick() со случайными промежутками между ними: сигнал
+// запускается первой точкой, пройденной проверкой, остальные пройденные
+// точки считаются пропущенными
+static bool checkTick(const Reference &_ref, const char *_config, std::mt19937 &_rnd)
+{
+  uint32_t start = _rnd() % 86400ul;
+  saAlarm.setAlarmState(ALARM_ON);
+  saAlarm.init(start);
+  uint32_t last = (start) ? start - 1 : 86399ul;
+  uint32_t t = start;
+  for (uint32_t elapsed = 0; elapsed < 86400ul + 3600ul;)
+  {
+    uint32_t missed = saAlarm.getMissedCount();
+    saAlarm.tick(t);
+
+    // точки в (last, t] по кругу; первая из них - ближайшая после минуты
+    // last
+    uint16_t a = last / 60 + 1;
+    uint16_t b = t / 60 + 1;
+    uint32_t crossed = (t >= last) ? _ref.before[b] - _ref.before[a]
+                                   : _ref.count - _ref.before[a] + _ref.before[b];
+    long first = _ref.next[a % DAY_MINUTES];
+
+    bool fired = (saAlarm.getAlarmState() == ALARM_YES);
+    if (fired != (crossed > 0))
+    {
+      return (report("tick", _config, t, fired, crossed > 0));
+    }
+    if (fired)
+    {
+      uint32_t delay = (t + 86400ul - first * 60ul) % 86400ul;
+      if (saAlarm.getTriggerDelay() != delay)
+      {
+        return (report("getTriggerDelay", _config, t, saAlarm.getTriggerDelay(), delay));
+      }
+      if (saAlarm.getMissedCount() - missed != crossed - 1)
+      {
+        return (report("getMissedCount", _config, t, saAlarm.getMissedCount() - missed, crossed - 1));
+      }
+      saAlarm.setAlarmState(ALARM_ON);
+    }
+
+    // чаще всего проверки идут каждую секунду или чуть реже, иногда
+    // опаздывают на минуты
+    uint32_t gap = (_rnd() % 16) ? 1 + _rnd() % 3 : 1 + _rnd() % 600;
+    last = t;
+    t = (t + gap) % 86400ul;
+    elapsed += gap;
+  }
+
+  return (true);
+}
+
+static void setWindows(const uint16_t (*_wnd)[3], uint8_t _mask)
+{
+  saAlarm.beginUpdate();
+  saAlarm.setAlarmMode(ALARM_MODE_INTERVAL);
+  for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
+  {
+    saAlarm.setAlarmPoint1(_wnd[i][0], i);
+    saAlarm.setAlarmPoint2(_wnd[i][1], i);
+    saAlarm.setAlarmInterval(_wnd[i][2], i);
+  }
+  // сначала включаются нужные промежутки, иначе последний включенный не
+  // выключится
+  for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
+  {
+    if (_mask & (1 << i))
+    {
+      saAlarm.setOnOffWindow(i, true);
+    }
+  }
+  for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
+  {
+    if (!(_mask & (1 << i)))
+    {
+      saAlarm.setOnOffWindow(i, false);
+    }
+  }
+  saAlarm.endUpdate();
+  // журнал настроек в EEPROM здесь не нужен
+  saEepromQueue.flush();
+}
+
+// задание - начало промежутка и шаг интервала, внутри перебираются все
+// окончания промежутка
+static void runSingle(uint32_t _job, bool _full)
+{
+  uint16_t p1 = _job / INTERVAL_STEPS;
+  if (!_full)
+  { // выборка: края суток и равномерно по суткам
+    p1 = (p1 < 3) ? p1 : (p1 < 5) ? MAX_DATA - (p1 - 3) : (p1 - 5) * 271 + 97;
+  }
+  uint16_t it = MIN_INTERVAL + (_job % INTERVAL_STEPS) * 10;
+  uint64_t n = 0;
+  for (uint16_t p2 = 0; p2 < DAY_MINUTES; p2++)
+  {
+    uint16_t wnd[ALARM_WINDOW_COUNT][3] = {{p1, p2, it}, {0, 0, MIN_INTERVAL}, {0, 0, MIN_INTERVAL}};
+    setWindows(wnd, 0x01);
+
+    Reference ref = {};
+    addWindow(ref, p1, p2, it);
+    countPoints(ref);
+    char config[64];
+    snprintf(config, sizeof(config), "W 0 1 %u %u %u", p1, p2, it);
+    checkSchedule(ref, config, (_full) ? 1 : SAMPLE_SEEK_STEP);
+    n++;
+  }
+  shared->configs += n;
+}
+
+// задание - случайный набор промежутков или список точек
+static void runRandom(uint32_t _job)
+{
+  std::mt19937 rnd(_job);
+  sim_events.clear();
+  Reference ref = {};
+  char config[256];
+  if (rnd() % 4)
+  {
+    uint16_t wnd[ALARM_WINDOW_COUNT][3];
+    uint8_t mask = 1 + rnd() % ((1 << ALARM_WINDOW_COUNT) - 1);
+    int k = snprintf(config, sizeof(config), "mask %u:", mask);
+    for (uint8_t i = 0; i < ALARM_WINDOW_COUNT; i++)
+    {
+      wnd[i][0] = rnd() % DAY_MINUTES;
+      // короткие промежутки и промежутки из одной точки - чаще
+      wnd[i][1] = (rnd() % 4) ? rnd() % DAY_MINUTES : (wnd[i][0] + rnd() % 3) % DAY_MINUTES;
+      wnd[i][2] = MIN_INTERVAL + (rnd() % INTERVAL_STEPS) * 10;
+      if (mask & (1 << i))
+      {
+        addWindow(ref, wnd[i][0], wnd[i][1], wnd[i][2]);
+      }
+      k += snprintf(config + k, sizeof(config) - k, " %u-%u/%u", wnd[i][0], wnd[i][1], wnd[i][2]);
+    }
+    setWindows(wnd, mask);
+  }
+  else
+  {
+    uint16_t list[ALARM_LIST_SIZE];
+    uint8_t count = rnd() % (ALARM_LIST_SIZE + 1);
+    for (uint8_t i = 0; i < count; i++)
+    {
+      list[i] = rnd() % DAY_MINUTES;
+    }
+    saAlarm.beginUpdate();
+    saAlarm.setAlarmMode(ALARM_MODE_LIST);
+    saAlarm.setPointList(list, count);
+    saAlarm.endUpdate();
+    saEepromQueue.flush();
+
+    int k = snprintf(config, sizeof(config), "L");
+    for (uint8_t i = 0; i < saAlarm.getListCount(); i++)
+    {
+      ref.fire[saAlarm.getListPoint(i)] = true;
+      k += snprintf(config + k, sizeof(config) - k, " %u", saAlarm.getListPoint(i));
+    }
+    if (saAlarm.getListCount() != (uint8_t)std::count(ref.fire, ref.fire + DAY_MINUTES, true))
+    {
+      report("getListCount", config, 0, saAlarm.getListCount(), 0);
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+      if (!ref.fire[list[i]])
+      {
+        report("setPointList", config, list[i], 0, 1);
+      }
+    }
+    if (count)
+    {
+      uint16_t first = *std::min_element(list, list + count);
+      uint16_t last = *std::max_element(list, list + count);
+      for (uint16_t m = first; m <= last; m++)
+      {
+        ref.inside[m] = true;
+      }
+    }
+  }
+  countPoints(ref);
+
+  if (checkSchedule(ref, config, 1))
+  {
+    checkTick(ref, config, rnd);
+  }
+  shared->configs++;
+}
+
+static void worker(uint32_t _jobs, bool _full)
+{
+  saAlarm.begin();
+  saAlarm.setOnOffAlarm(true);
+  uint32_t single = ((_full) ? DAY_MINUTES : SAMPLE_STARTS) * INTERVAL_STEPS;
+  for (uint32_t job = shared->next++; job < _jobs; job = shared->next++)
+  {
+    (job < single) ? runSingle(job, _full) : runRandom(job - single);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  bool full = (argc > 1 && strcmp(argv[1], "full") == 0);
+  uint32_t jobs = ((full) ? DAY_MINUTES : SAMPLE_STARTS) * INTERVAL_STEPS + ((full) ? 0 : RANDOM_CONFIGS);
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cores < 1)
+  {
+    cores = 1;
+  }
+
+  shared = (Shared *)mmap(NULL, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED)
+  {
+    perror("mmap");
+    return (2);
+  }
+  new (shared) Shared();
+
+  timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  fflush(stdout);
+  for (long i = 0; i < cores; i++)
+  {
+    if (fork() == 0)
+    {
+      worker(jobs, full);
+      fflush(stdout);
+      _exit(0);
+    }
+  }
+  int status;
+  bool failed = false;
+  while (wait(&status) > 0)
+  {
+    failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  uint64_t mismatches = shared->mismatches;
+  printf("verify_schedule%s: %llu configurations, %llu mismatches, %ld processes, %.1f s\n",
+         (full) ? " full" : "", (unsigned long long)shared->configs.load(),
+         (unsigned long long)mismatches, cores,
+         (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+
+  return ((mismatches || failed) ? 1 : 0);
+}
@@ -0,0 +1,267 @@
+/**
+ * @file time_source.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Источник текущего времени для будильника;
+ *
+ *        время в секундах от начала суток считается от millis() и
+ *        сверяется с RTC не чаще раза в минуту, либо по запросу, например,
+ *        после изменения времени пользователем; это избавляет от обращения
+ *        к модулю RTC по шине I2C при каждой проверке будильника;
+ *
+ *        в полночь время сверяется с RTC внепланово, поэтому день недели и
+ *        дата всегда соответствуют времени, полученному от getTime();
+ *
+ *        RTC отдает только целые секунды, поэтому начало секунды ищется
+ *        отдельно - один раз после каждой сверки: пока оно не найдено,
+ *        каждый запрос времени (но не чаще TIME_LOCK_POLL) читает RTC, и
+ *        первое чтение, на котором показания сменились, становится точкой
+ *        отсчета; при частых запросах, как в последние секунды перед
+ *        срабатыванием будильника, ошибка не больше промежутка между
+ *        запросами; до следующей сверки RTC больше не читается, а на время
+ *        поиска остается прежняя точка отсчета, если сверка не выявила
+ *        расхождения на целую секунду;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include <shSimpleClock.h>
+#include "header_file.h"
+
+#define TIME_SYNC_INTERVAL 60000ul // интервал сверки времени с RTC, мс
+#define TIME_DATE_COUNT 366        // количество дат в году, включая 29 февраля
+#define TIME_LOCK_POLL 50ul        // минимальный интервал чтения RTC при поиске начала секунды, мс
+#define TIME_LOCK_WINDOW 250ul     // максимальный промежуток между чтениями, по которым ищется начало секунды, мс
+
+// номер первого дня каждого месяца в году с 29 февраля; последний элемент -
+// количество дат в году
+static const uint16_t month_start[13] PROGMEM = {0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366};
+
+/**
+ * @brief получение номера даты в году; 29 февраля имеет свой номер и в
+ *        невисокосный год, поэтому номер даты не зависит от года
+ *
+ * @param _month месяц, 1..12
+ * @param _day число, 1..31
+ * @return uint16_t номер даты, 0..365; TIME_DATE_COUNT, если такой даты нет
+ */
+uint16_t getDateIndex(uint8_t _month, uint8_t _day)
+{
+  if (_month < 1 || _month > 12 || _day < 1)
+  {
+    return (TIME_DATE_COUNT);
+  }
+
+  uint16_t x = pgm_read_word(&month_start[_month - 1]) + _day - 1;
+
+  return ((x < pgm_read_word(&month_start[_month])) ? x : TIME_DATE_COUNT);
+}
+
+class AlarmTimeSource
+{
+private:
+  uint32_t sync_time;   // время RTC на момент последней синхронизации, секунд от начала суток
+  uint32_t sync_millis; // значение millis() на момент последней синхронизации
+  uint8_t sync_day;     // день недели RTC на момент последней синхронизации, 0 - воскресенье
+  uint16_t sync_date;   // номер даты RTC на момент последней синхронизации, см. getDateIndex()
+  uint32_t check_millis; // значение millis() на момент последней сверки с RTC
+  uint32_t read_time;   // показания RTC при последнем чтении, секунд от начала суток
+  uint32_t read_millis; // значение millis() на момент последнего чтения RTC
+  bool locked;          // начало секунды RTC найдено, точка отсчета совпадает с ним
+  bool seek;            // идет поиск начала секунды RTC
+  int16_t drift;        // расхождение RTC и millis() при последней сверке, секунд
+  int32_t drift_total;  // суммарное расхождение с момента включения, секунд
+  bool sync_flag;       // флаг необходимости синхронизации при следующем запросе времени
+
+  void resync(bool _check);
+
+public:
+  AlarmTimeSource();
+
+  /**
+   * @brief получение текущего времени; при необходимости выполняется сверка
+   *        с RTC
+   *
+   * @return uint32_t время в секундах от начала суток
+   */
+  uint32_t getTime();
+
+  /**
+   * @brief получение доли текущей секунды, прошедшей с ее начала, по
+   *        millis(); вызывается после getTime()
+   *
+   * @return uint16_t время от начала секунды, мс; 0, если начало секунды
+   *         RTC не найдено, см. isLocked()
+   */
+  uint16_t getFraction();
+
+  /**
+   * @brief найдено ли начало секунды RTC; вызывается после getTime()
+   *
+   * @return true, если время от начала секунды, которое возвращает
+   *         getFraction(), отсчитывается от смены показаний RTC
+   */
+  bool isLocked();
+
+  /**
+   * @brief получение текущего дня недели; вызывается после getTime()
+   *
+   * @return uint8_t день недели, 0 - воскресенье
+   */
+  uint8_t getDayOfWeek();
+
+  /**
+   * @brief получение номера текущей даты в году; вызывается после getTime()
+   *
+   * @return uint16_t номер даты, см. getDateIndex()
+   */
+  uint16_t getDate();
+
+  /**
+   * @brief запрос синхронизации с RTC при следующем получении времени,
+   *        например, после изменения времени пользователем
+   */
+  void sync();
+
+  /**
+   * @brief получение расхождения времени RTC и времени, рассчитанного по
+   *        millis(), при последней сверке
+   *
+   * @return int16_t расхождение в секундах; положительное значение - RTC
+   *         идет быстрее
+   */
+  int16_t getDrift();
+
+  /**
+   * @brief получение суммарного расхождения времени RTC и millis() с момента
+   *        включения
+   *
+   * @return int32_t расхождение в секундах
+   */
+  int32_t getDriftTotal();
+};
+
+// ---- private ---------------------------------
+
+void AlarmTimeSource::resync(bool _check)
+{
+  clkDateTime dt = saClock.getCurrentDateTime();
+  uint32_t rtc = dt.hour() * 3600ul + dt.minute() * 60ul + dt.second();
+  uint32_t ms = millis();
+
+  // начало секунды лежит между этим и предыдущим чтениями, если показания
+  // сменились; за него берется момент этого чтения, поэтому время по
+  // millis() не опережает RTC
+  bool edge = seek && !sync_flag && rtc != read_time && ms - read_millis <= TIME_LOCK_WINDOW;
+  read_time = rtc;
+  read_millis = ms;
+  if (!_check && !edge)
+  { // начало секунды еще не наступило
+    return;
+  }
+
+  sync_day = dt.dayOfWeek() % 7;
+  sync_date = getDateIndex(dt.month(), dt.day());
+  if (sync_flag)
+  {
+    sync_flag = false;
+    locked = false;
+    seek = true;
+    check_millis = ms;
+    sync_time = rtc;
+    sync_millis = ms;
+    return;
+  }
+
+  uint32_t tm = sync_time + (ms - sync_millis) / 1000;
+  if (_check)
+  { // после каждой сверки начало секунды ищется заново
+    check_millis = ms;
+    seek = true;
+    int32_t d = (rtc + 86400ul - tm % 86400ul) % 86400ul;
+    if (d > 43200l)
+    {
+      d -= 86400l;
+    }
+    drift = (int16_t)constrain(d, -32768l, 32767l);
+    drift_total += d;
+    if (d != 0 && !edge)
+    { // время разошлось на целую секунду, начало секунды ищется заново
+      sync_time = rtc;
+      sync_millis = ms;
+      locked = false;
+      return;
+    }
+  }
+
+  if (edge)
+  {
+    sync_time = rtc;
+    sync_millis = ms;
+    locked = true;
+    seek = false;
+  }
+  else if (tm >= 86400ul)
+  { // полночь - точка отсчета переносится на начало суток с той же фазой
+    sync_millis += (86400ul - sync_time) * 1000ul;
+    sync_time = 0;
+  }
+}
+
+// ---- public ----------------------------------
+
+AlarmTimeSource::AlarmTimeSource()
+{
+  sync_time = 0;
+  sync_millis = 0;
+  sync_day = 0;
+  sync_date = 0;
+  check_millis = 0;
+  read_time = 0;
+  read_millis = 0;
+  locked = false;
+  seek = true;
+  drift = 0;
+  drift_total = 0;
+  sync_flag = true;
+}
+
+uint32_t AlarmTimeSource::getTime()
+{
+  // сверка выполняется и при переходе через полночь, чтобы получить от RTC
+  // новые день недели и дату
+  if (sync_flag || (millis() - check_millis >= TIME_SYNC_INTERVAL) ||
+      sync_time + (millis() - sync_millis) / 1000 >= 86400ul)
+  {
+    resync(true);
+  }
+  else if (seek && millis() - read_millis >= TIME_LOCK_POLL)
+  {
+    resync(false);
+  }
+
+  return ((sync_time + (millis() - sync_millis) / 1000) % 86400ul);
+}
+
+uint16_t AlarmTimeSource::getFraction() { return ((locked) ? (millis() - sync_millis) % 1000 : 0); }
+
+bool AlarmTimeSource::isLocked() { return (locked); }
+
+uint8_t AlarmTimeSource::getDayOfWeek() { return (sync_day); }
+
+uint16_t AlarmTimeSource::getDate() { return (sync_date); }
+
+void AlarmTimeSource::sync() { sync_flag = true; }
+
+int16_t AlarmTimeSource::getDrift() { return (drift); }
+
+int32_t AlarmTimeSource::getDriftTotal() { return (drift_total); }
+
+// ===================================================
+
+AlarmTimeSource saTime;
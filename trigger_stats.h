@@ -0,0 +1,189 @@
+/**
+ * @file trigger_stats.h
+ * @author Vladimir Shatalov (valesh-soft@yandex.ru)
+ *
+ * @brief Статистика задержки срабатывания будильника;
+ *
+ *        для каждого срабатывания фиксируется задержка от начала секунды
+ *        точки срабатывания до запуска пищалки; задержки собираются в
+ *        гистограмму с фиксированными границами интервалов, кроме того,
+ *        хранятся максимальная задержка с момента включения и максимальная
+ *        задержка последних TRIGGER_STATS_WINDOW срабатываний;
+ *
+ *        доля секунды известна, только если источник времени нашел начало
+ *        секунды RTC (см. AlarmTimeSource::isLocked()); иначе задержка
+ *        считается от смены секунды по millis() и может быть занижена на
+ *        время до секунды, такие срабатывания подсчитываются отдельно;
+ *
+ * @version 1.0
+ * @date 2026-06-09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include "alarm.h"
+
+#define TRIGGER_STATS_WINDOW 8 // количество последних срабатываний для скользящего максимума
+
+// верхние границы интервалов гистограммы, мс; последний интервал - все, что больше
+static const uint16_t PROGMEM trigger_stats_bounds[] = {10, 20, 50, 100, 200, 500, 1000, 2000};
+
+#define TRIGGER_STATS_BUCKETS (sizeof(trigger_stats_bounds) / sizeof(trigger_stats_bounds[0]) + 1)
+
+class TriggerStats
+{
+private:
+  uint16_t bucket[TRIGGER_STATS_BUCKETS]; // количество срабатываний в интервалах гистограммы
+  uint16_t recent[TRIGGER_STATS_WINDOW];  // задержки последних срабатываний, мс
+  uint8_t recent_pos;                     // индекс для записи следующей задержки
+  uint16_t count;                         // количество срабатываний
+  uint16_t unlocked;                      // количество срабатываний с неизвестной долей секунды
+  uint16_t max_delay;                     // максимальная задержка с момента включения, мс
+
+public:
+  TriggerStats();
+
+  /**
+   * @brief добавление срабатывания в статистику
+   *
+   * @param _delay задержка от точки срабатывания до запуска пищалки, мс
+   * @param _locked true, если в задержку входит доля секунды от начала
+   *        секунды RTC; false - начало секунды не найдено
+   */
+  void add(uint32_t _delay, bool _locked);
+
+  /**
+   * @brief получение количества срабатываний в интервале гистограммы
+   *
+   * @param _index номер интервала, 0..TRIGGER_STATS_BUCKETS - 1
+   * @return uint16_t
+   */
+  uint16_t getBucket(uint8_t _index);
+
+  /**
+   * @brief получение количества срабатываний
+   *
+   * @return uint16_t
+   */
+  uint16_t getCount();
+
+  /**
+   * @brief получение максимальной задержки с момента включения
+   *
+   * @return uint16_t задержка, мс
+   */
+  uint16_t getMaxDelay();
+
+  /**
+   * @brief получение максимальной задержки последних TRIGGER_STATS_WINDOW
+   *        срабатываний
+   *
+   * @return uint16_t задержка, мс
+   */
+  uint16_t getRecentMaxDelay();
+
+  /**
+   * @brief вывод статистики, в том числе количества пропущенных срабатываний
+   *
+   * @param _out поток для вывода, например, Serial
+   */
+  void dump(Print &_out);
+};
+
+// ---- public ----------------------------------
+
+TriggerStats::TriggerStats()
+{
+  memset(bucket, 0, sizeof(bucket));
+  memset(recent, 0, sizeof(recent));
+  recent_pos = 0;
+  count = 0;
+  unlocked = 0;
+  max_delay = 0;
+}
+
+void TriggerStats::add(uint32_t _delay, bool _locked)
+{
+  uint16_t x = (_delay > 0xFFFF) ? 0xFFFF : _delay;
+
+  uint8_t i = 0;
+  while (i < TRIGGER_STATS_BUCKETS - 1 && x >= pgm_read_word(&trigger_stats_bounds[i]))
+  {
+    i++;
+  }
+  if (bucket[i] < 0xFFFF)
+  {
+    bucket[i]++;
+  }
+  if (count < 0xFFFF)
+  {
+    count++;
+  }
+  if (!_locked && unlocked < 0xFFFF)
+  {
+    unlocked++;
+  }
+
+  recent[recent_pos] = x;
+  recent_pos = (recent_pos + 1) % TRIGGER_STATS_WINDOW;
+  if (x > max_delay)
+  {
+    max_delay = x;
+  }
+}
+
+uint16_t TriggerStats::getBucket(uint8_t _index) { return (bucket[_index]); }
+
+uint16_t TriggerStats::getCount() { return (count); }
+
+uint16_t TriggerStats::getMaxDelay() { return (max_delay); }
+
+uint16_t TriggerStats::getRecentMaxDelay()
+{
+  uint16_t result = 0;
+  for (uint8_t i = 0; i < TRIGGER_STATS_WINDOW; i++)
+  {
+    if (recent[i] > result)
+    {
+      result = recent[i];
+    }
+  }
+
+  return (result);
+}
+
+void TriggerStats::dump(Print &_out)
+{
+  _out.print(F("triggers;"));
+  _out.println(count);
+  _out.print(F("unlocked;"));
+  _out.println(unlocked);
+  _out.print(F("missed;"));
+  _out.println(saAlarm.getMissedCount());
+  _out.print(F("max_ms;"));
+  _out.println(max_delay);
+  _out.print(F("recent_max_ms;"));
+  _out.println(getRecentMaxDelay());
+  // интервалы гистограммы: "<граница;количество", последний - ">=граница;количество"
+  for (uint8_t i = 0; i < TRIGGER_STATS_BUCKETS; i++)
+  {
+    if (i < TRIGGER_STATS_BUCKETS - 1)
+    {
+      _out.print('<');
+      _out.print(pgm_read_word(&trigger_stats_bounds[i]));
+    }
+    else
+    {
+      _out.print(F(">="));
+      _out.print(pgm_read_word(&trigger_stats_bounds[i - 1]));
+    }
+    _out.print(';');
+    _out.println(bucket[i]);
+  }
+}
+
+// ===================================================
+
+TriggerStats saTriggerStats;